@@ -0,0 +1,168 @@
+// bench_results.h - optional machine-readable result log for the benchmarks.
+//
+//   bench::record("futex_wake", "futex", "threads=8", avg_us, "us/thread", bench::LOWER);
+//
+// Does nothing unless LAB_RESULTS names a file. Otherwise each call appends
+// one tab-separated row with a single write(2) on an O_APPEND descriptor, so
+// concurrent benchmark processes can share one file. A row carries the run
+// label (LAB_RUN, default "default"), a timestamp, the measurement, and the
+// environment: host, CPU model, online CPUs, kernel release, cpufreq
+// governor, compiler version and build flags. The build flags come from
+// -DLAB_CFLAGS="\"...\"" when given, else from what the predefined macros
+// reveal. Run a benchmark several times under one label to collect the
+// repetitions tools/bench_compare needs.
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+namespace bench {
+
+enum Better { LOWER, HIGHER };
+
+constexpr const char* RESULTS_HEADER =
+    "run\ttime\thost\tbenchmark\tmetric\tparams\tvalue\tunit\tbetter\t"
+    "cpu\tcpus\tkernel\tgovernor\tcompiler\tflags\n";
+
+namespace detail {
+
+inline std::string first_line(const char* path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) return "n/a";
+    return line;
+}
+
+inline std::string cpu_model() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 10, "model name") != 0) continue;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) return line.substr(line.find_first_not_of(" \t", colon + 1));
+    }
+    return "n/a";
+}
+
+inline std::string build_flags() {
+#ifdef LAB_CFLAGS
+    return LAB_CFLAGS;
+#else
+    std::string f;
+#if defined(__OPTIMIZE_SIZE__)
+    f = "-Os";
+#elif defined(__OPTIMIZE__)
+    f = "-O(1+)";
+#else
+    f = "-O0";
+#endif
+#if defined(__AVX512F__)
+    f += " avx512f";
+#elif defined(__AVX2__)
+    f += " avx2";
+#elif defined(__SSE4_2__)
+    f += " sse4.2";
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+    f += " asan";
+#endif
+    return f;
+#endif
+}
+
+// Tabs and newlines would break the row format.
+inline std::string clean(std::string s) {
+    for (char& c : s)
+        if (c == '\t' || c == '\n') c = ' ';
+    return s;
+}
+
+struct Environment {
+    std::string run, host, cpu, cpus, kernel, governor, compiler, flags;
+
+    Environment() {
+        const char* r = std::getenv("LAB_RUN");
+        run = (r && *r) ? r : "default";
+        utsname u{};
+        if (uname(&u) == 0) {
+            host = u.nodename;
+            kernel = u.release;
+        }
+        cpu = cpu_model();
+        cpus = std::to_string(sysconf(_SC_NPROCESSORS_ONLN));
+        governor = first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+#if defined(__clang__)
+        compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        compiler = "gcc " __VERSION__;
+#else
+        compiler = "unknown";
+#endif
+        flags = build_flags();
+    }
+};
+
+inline const Environment& env() {
+    static const Environment e;
+    return e;
+}
+
+// Append descriptor, opened on first use; -1 when LAB_RESULTS is unset.
+inline int results_fd() {
+    static const int fd = [] {
+        const char* path = std::getenv("LAB_RESULTS");
+        if (!path || !*path) return -1;
+        int f = ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (f < 0) {
+            perror("LAB_RESULTS");
+            return -1;
+        }
+        struct stat st{};
+        if (::fstat(f, &st) == 0 && st.st_size == 0)
+            (void)::write(f, RESULTS_HEADER, std::char_traits<char>::length(RESULTS_HEADER));
+        return f;
+    }();
+    return fd;
+}
+
+}  // namespace detail
+
+inline bool enabled() { return detail::results_fd() >= 0; }
+
+// `metric` names what was measured (e.g. "futex", "batched writes"); `params`
+// holds the knobs that must match for two rows to be comparable
+// (e.g. "threads=8 payload=100").
+inline void record(const std::string& benchmark, const std::string& metric, const std::string& params,
+                   double value, const char* unit, Better better) {
+    int fd = detail::results_fd();
+    if (fd < 0) return;
+    const detail::Environment& e = detail::env();
+
+    char ts[32];
+    time_t now = time(nullptr);
+    tm t{};
+    strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", localtime_r(&now, &t));
+    char val[32];
+    snprintf(val, sizeof(val), "%.6g", value);
+
+    std::string row;
+    for (const std::string& field :
+         {e.run, std::string(ts), e.host, benchmark, metric, params, std::string(val), std::string(unit),
+          std::string(better == LOWER ? "lower" : "higher"), e.cpu, e.cpus, e.kernel, e.governor, e.compiler,
+          e.flags}) {
+        row += detail::clean(field);
+        row += '\t';
+    }
+    row.back() = '\n';
+    (void)::write(fd, row.data(), row.size());
+}
+
+}  // namespace bench
@@ -0,0 +1,186 @@
+// crc32c.h - CRC32C (Castagnoli) for the I/O benchmarks.
+//
+//   uint32_t c = crc32c::value(data, len);
+//   c = crc32c::extend(c, more, more_len);
+//
+// On x86 CPUs with SSE4.2 and PCLMULQDQ, long inputs are split into three
+// lanes hashed in parallel with the crc32 instruction (one instruction's
+// latency hides the other two), and the lane CRCs are merged with a
+// carry-less multiply. Other CPUs use a slicing-by-8 table. The choice is
+// made once at startup.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace crc32c {
+
+constexpr uint32_t POLY = 0x82f63b78;  // reflected Castagnoli polynomial
+
+namespace detail {
+
+// ---------------- Table-driven fallback (slicing-by-8) ----------------
+
+struct Tables {
+    uint32_t t[8][256];
+    Tables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ POLY : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+            for (int s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+    }
+};
+
+inline const Tables& tables() {
+    static const Tables tb;
+    return tb;
+}
+
+inline uint32_t extend_table(uint32_t crc, const char* p, size_t len) {
+    const auto& t = tables().t;
+    uint32_t c = ~crc;
+    while (len >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);  // little-endian
+        w ^= c;
+        c = t[7][w & 0xff] ^ t[6][(w >> 8) & 0xff] ^ t[5][(w >> 16) & 0xff] ^
+            t[4][(w >> 24) & 0xff] ^ t[3][(w >> 32) & 0xff] ^ t[2][(w >> 40) & 0xff] ^
+            t[1][(w >> 48) & 0xff] ^ t[0][w >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = (c >> 8) ^ t[0][(c ^ static_cast<unsigned char>(*p++)) & 0xff];
+    return ~c;
+}
+
+// ---------------- GF(2) helpers for lane combination ----------------
+// Polynomials are bit-reflected: bit 31 is x^0.
+
+inline uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31, p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^n mod P
+inline uint32_t xpow(uint64_t n) {
+    uint32_t result = 1u << 31, base = 1u << 30;
+    while (n) {
+        if (n & 1) result = multmodp(result, base);
+        base = multmodp(base, base);
+        n >>= 1;
+    }
+    return result;
+}
+
+// ---------------- SSE4.2 + PCLMUL, 3-way interleaved ----------------
+
+#if defined(__x86_64__)
+constexpr size_t LANE_LONG  = 1344;  // 3 lanes cover 4032 of a 4 KB block
+constexpr size_t LANE_SHORT = 128;
+
+// clmul(crc, x^(8n-33)) followed by a crc32 of the 64-bit product yields
+// crc * x^(8n) mod P, i.e. crc advanced over n zero bytes.
+inline uint64_t shift_constant(size_t n) { return xpow(8 * n - 33); }
+
+__attribute__((target("sse4.2,pclmul")))
+inline uint32_t shift(uint32_t crc, uint64_t k) {
+    __m128i prod = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc)),
+                                        _mm_cvtsi64_si128(static_cast<long long>(k)), 0);
+    return static_cast<uint32_t>(_mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(prod))));
+}
+
+__attribute__((target("sse4.2,pclmul")))
+inline uint64_t lanes3(uint64_t c0, const char*& p, size_t& len, size_t lane, uint64_t k) {
+    while (len >= 3 * lane) {
+        uint64_t c1 = 0, c2 = 0;
+        const char* end = p + lane;
+        do {
+            uint64_t a, b, c;
+            std::memcpy(&a, p, 8);
+            std::memcpy(&b, p + lane, 8);
+            std::memcpy(&c, p + 2 * lane, 8);
+            c0 = _mm_crc32_u64(c0, a);
+            c1 = _mm_crc32_u64(c1, b);
+            c2 = _mm_crc32_u64(c2, c);
+            p += 8;
+        } while (p < end);
+        c0 = shift(static_cast<uint32_t>(c0), k) ^ c1;
+        c0 = shift(static_cast<uint32_t>(c0), k) ^ c2;
+        p += 2 * lane;
+        len -= 3 * lane;
+    }
+    return c0;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+inline uint32_t extend_hw(uint32_t crc, const char* p, size_t len) {
+    static const uint64_t k_long = shift_constant(LANE_LONG);
+    static const uint64_t k_short = shift_constant(LANE_SHORT);
+
+    uint64_t c = ~crc;
+    while (len > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        c = _mm_crc32_u8(static_cast<uint32_t>(c), static_cast<unsigned char>(*p++));
+        --len;
+    }
+    c = lanes3(c, p, len, LANE_LONG, k_long);
+    c = lanes3(c, p, len, LANE_SHORT, k_short);
+    while (len >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = _mm_crc32_u8(static_cast<uint32_t>(c), static_cast<unsigned char>(*p++));
+    return ~static_cast<uint32_t>(c);
+}
+#endif
+
+using ExtendFn = uint32_t (*)(uint32_t, const char*, size_t);
+
+inline bool has_hw() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+#else
+    return false;
+#endif
+}
+
+inline ExtendFn pick() {
+#if defined(__x86_64__)
+    if (has_hw()) return extend_hw;
+#endif
+    return extend_table;
+}
+
+inline const ExtendFn impl = pick();
+
+}  // namespace detail
+
+inline uint32_t extend(uint32_t crc, const void* data, size_t len) {
+    return detail::impl(crc, static_cast<const char*>(data), len);
+}
+
+inline uint32_t value(const void* data, size_t len) { return extend(0, data, len); }
+
+inline const char* impl_name() {
+    return detail::impl == detail::extend_table ? "table (slicing-by-8)" : "sse4.2 3-way + pclmul";
+}
+
+}  // namespace crc32c
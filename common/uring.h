@@ -0,0 +1,138 @@
+// uring.h - minimal io_uring wrapper over the raw syscalls (no liburing).
+//
+//   Uring ring(256);
+//   if (!ring.valid()) { /* ring.error() holds the setup errno */ }
+//   io_uring_sqe* sqe = ring.get_sqe();
+//   sqe->opcode = IORING_OP_WRITE; ...; sqe->user_data = tag;
+//   ring.submit_and_wait(1);
+//   ring.for_each_cqe([](const io_uring_cqe& cqe) { ... });
+//
+// One thread owns a ring; nothing here is thread-safe.
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+class Uring {
+public:
+    explicit Uring(unsigned entries, unsigned flags = 0) {
+        io_uring_params p{};
+        p.flags = flags;
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) { error_ = errno; return; }
+
+        sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_len_ = cq_len_ = (sq_len_ > cq_len_ ? sq_len_ : cq_len_);
+
+        sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) { error_ = errno; sq_ptr_ = nullptr; return; }
+        cq_ptr_ = single ? sq_ptr_
+                         : mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) { error_ = errno; cq_ptr_ = nullptr; return; }
+        sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) { error_ = errno; sqes_ = nullptr; return; }
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        unsigned* array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        for (unsigned i = 0; i < p.sq_entries; ++i) array[i] = i;  // identity slot mapping
+
+        char* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        features_ = p.features;
+    }
+
+    ~Uring() {
+        if (sqes_) munmap(sqes_, sqes_len_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_len_);
+        if (sq_ptr_) munmap(sq_ptr_, sq_len_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    bool valid() const { return fd_ >= 0 && sqes_ != nullptr; }
+    int error() const { return error_; }
+    int fd() const { return fd_; }
+    unsigned features() const { return features_; }
+    uint64_t enter_calls() const { return enter_calls_; }
+
+    // Zeroed SQE, or nullptr when all slots are queued but not yet submitted.
+    io_uring_sqe* get_sqe() {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ - head >= sq_entries_) return nullptr;
+        io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+        ++sq_local_tail_;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // Publishes queued SQEs and enters the kernel; with wait_nr > 0, blocks
+    // until that many completions are available. Returns -errno on failure.
+    int submit_and_wait(unsigned wait_nr = 0) {
+        unsigned to_submit = sq_local_tail_ - *sq_tail_;
+        __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+        unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+        for (;;) {
+            ++enter_calls_;
+            int r = static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit, wait_nr, flags, nullptr, 0));
+            if (r >= 0) return r;
+            if (errno != EINTR) return -errno;
+        }
+    }
+
+    // Calls f(cqe) for each available completion and marks them consumed.
+    template <class F>
+    unsigned for_each_cqe(F&& f) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned n = 0;
+        for (; head != tail; ++head, ++n) f(cqes_[head & cq_mask_]);
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return n;
+    }
+
+    int register_buffers(const iovec* iov, unsigned count) {
+        return reg(IORING_REGISTER_BUFFERS, iov, count);
+    }
+
+    int reg(unsigned opcode, const void* arg, unsigned nr_args) {
+        int r = static_cast<int>(syscall(__NR_io_uring_register, fd_, opcode, arg, nr_args));
+        return r < 0 ? -errno : r;
+    }
+
+private:
+    int fd_ = -1;
+    int error_ = 0;
+    unsigned features_ = 0;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    size_t sq_len_ = 0, cq_len_ = 0, sqes_len_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned sq_mask_ = 0, cq_mask_ = 0, sq_entries_ = 0;
+    unsigned sq_local_tail_ = 0;
+    uint64_t enter_calls_ = 0;
+};
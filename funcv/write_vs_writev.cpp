@@ -3,6 +3,8 @@
 // ./write_vs_writev 4 nodisk
 // Benchmark writing to disk (OS will buffer writes, no fsync)
 // ./write_vs_writev 4 disk
+// Add a CRC32C of every buffer before it is written, and report the loss
+// ./write_vs_writev 4 disk crc
 #include <iostream>
 #include <vector>
 #include <chrono>
@@ -12,6 +14,9 @@
 #include <unistd.h>
 #include <sys/uio.h>
 
+#include "../common/crc32c.h"
+#include "../common/bench_results.h"
+
 using namespace std;
 using namespace std::chrono;
 
@@ -19,18 +24,28 @@ constexpr int BUF_SIZE = 1024;     // bytes per buffer
 constexpr int ITER     = 100000;   // iterations for /dev/null
 constexpr int ITER_DISK = 10000;   // iterations for disk (smaller to avoid large files)
 
-void print_result(const string& name, double ms, double total_bytes) {
+// Optional integrity stage: CRC32C of each buffer right before it is written.
+bool checksum = false;
+uint32_t checksum_acc = 0;
+
+// Knobs recorded with every result row (buffers, target).
+string result_params;
+
+double print_result(const string& name, double ms, double total_bytes) {
     double seconds = ms / 1000.0;
     double mb = total_bytes / (1024.0 * 1024.0);
     double mbps = mb / seconds;
-    cout << name << " total time: " << ms << " ms, throughput: "
+    cout << name << (checksum ? " + crc32c" : "") << " total time: " << ms << " ms, throughput: "
          << mbps << " MB/s" << endl;
+    bench::record("write_vs_writev", name + (checksum ? " + crc32c" : ""), result_params, mbps, "MB/s", bench::HIGHER);
+    return mbps;
 }
 
-void test_write(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter) {
+double test_write(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter) {
     auto start = steady_clock::now();
     for (int i = 0; i < iter; ++i) {
         for (int j = 0; j < n_bufs; ++j) {
+            if (checksum) checksum_acc += crc32c::value(bufs[j].data(), bufs[j].size());
             ssize_t written = write(fd, bufs[j].data(), bufs[j].size());
             if (written != (ssize_t)bufs[j].size()) {
                 perror("write");
@@ -41,10 +56,10 @@ void test_write(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter)
     auto end = steady_clock::now();
     double ms = duration_cast<milliseconds>(end - start).count();
     double total_bytes = (double)iter * n_bufs * BUF_SIZE;
-    print_result("write()", ms, total_bytes);
+    return print_result("write()", ms, total_bytes);
 }
 
-void test_writev(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter) {
+double test_writev(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter) {
     vector<iovec> iov(n_bufs);
     for (int i = 0; i < n_bufs; ++i) {
         iov[i].iov_base = (void*)bufs[i].data();
@@ -53,6 +68,9 @@ void test_writev(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter)
 
     auto start = steady_clock::now();
     for (int i = 0; i < iter; ++i) {
+        if (checksum) {
+            for (int j = 0; j < n_bufs; ++j) checksum_acc += crc32c::value(iov[j].iov_base, iov[j].iov_len);
+        }
         ssize_t written = writev(fd, iov.data(), n_bufs);
         if (written < 0) {
             perror("writev");
@@ -62,12 +80,12 @@ void test_writev(int fd, const vector<vector<char>>& bufs, int n_bufs, int iter)
     auto end = steady_clock::now();
     double ms = duration_cast<milliseconds>(end - start).count();
     double total_bytes = (double)iter * n_bufs * BUF_SIZE;
-    print_result("writev()", ms, total_bytes);
+    return print_result("writev()", ms, total_bytes);
 }
 
 int main(int argc, char* argv[]) {
     if (argc < 3) {
-        cerr << "Usage: " << argv[0] << " <num_buffers> <disk|nodisk>\n";
+        cerr << "Usage: " << argv[0] << " <num_buffers> <disk|nodisk> [crc]\n";
         return 1;
     }
 
@@ -78,7 +96,9 @@ int main(int argc, char* argv[]) {
     }
 
     bool disk_mode = (string(argv[2]) == "disk");
+    bool with_crc = (argc > 3 && string(argv[3]) == "crc");
     int iter = disk_mode ? ITER_DISK : ITER;
+    result_params = "bufs=" + to_string(n_bufs) + (disk_mode ? " disk" : " nodisk");
 
     cout << "Running benchmark with " << n_bufs
          << " buffers of " << BUF_SIZE << " bytes each, "
@@ -99,8 +119,18 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    test_write(fd, bufs, n_bufs, iter);
-    test_writev(fd, bufs, n_bufs, iter);
+    double write_mbps = test_write(fd, bufs, n_bufs, iter);
+    double writev_mbps = test_writev(fd, bufs, n_bufs, iter);
+
+    if (with_crc) {
+        cout << "CRC32C implementation: " << crc32c::impl_name() << "\n";
+        checksum = true;
+        double write_crc = test_write(fd, bufs, n_bufs, iter);
+        double writev_crc = test_writev(fd, bufs, n_bufs, iter);
+        cout << "Throughput lost to checksums: write() " << 100.0 * (1.0 - write_crc / write_mbps)
+             << "%, writev() " << 100.0 * (1.0 - writev_crc / writev_mbps) << "%"
+             << " (checksum sum: " << hex << checksum_acc << dec << ")\n";
+    }
 
     close(fd);
     return 0;
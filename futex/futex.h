@@ -0,0 +1,25 @@
+// futex.h - raw futex(2) helpers shared by the futex and ipc benchmarks.
+// The word must be 4-byte aligned. FUTEX_WAIT/FUTEX_WAKE (not the _PRIVATE
+// variants) so the same word works across processes in MAP_SHARED memory.
+#pragma once
+
+#include <atomic>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static inline int futex_wait(volatile int* addr, int val) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
+}
+
+static inline int futex_wake(volatile int* addr, int n) {
+    return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
+}
+
+static inline int futex_wait(std::atomic<int>* addr, int val) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
+}
+
+static inline int futex_wake(std::atomic<int>* addr, int n) {
+    return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
+}
@@ -4,11 +4,11 @@
 #include <chrono>
 #include <iostream>
 #include <pthread.h>
-#include <sys/syscall.h>
-#include <linux/futex.h>
-#include <unistd.h>
 #include <thread>
 
+#include "../futex.h"
+#include "../../common/bench_results.h"
+
 constexpr int ITER = 10'000'000;
 
 // ---------------- Timing helper ----------------
@@ -39,20 +39,13 @@ void test_pthread() {
     pthread_join(t, nullptr);
     double end = now_sec();
     std::cout << "pthread_mutex: " << (end - start) << " sec, counter=" << counter << "\n";
+    bench::record("futex_lock_threads", "pthread_mutex", "iters=" + std::to_string(ITER), end - start, "sec", bench::LOWER);
 }
 
 // ---------------- Futex-based mutex ----------------
 class FutexMutex {
     std::atomic<int> lock_{0};
 
-    static inline int futex_wait(std::atomic<int>* addr, int val) {
-        return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
-    }
-
-    static inline int futex_wake(std::atomic<int>* addr, int n) {
-        return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
-    }
-
 public:
     /*inline void lock() {
         int c = 0;
@@ -106,6 +99,7 @@ void test_futex() {
     pthread_join(t, nullptr);
     double end = now_sec();
     std::cout << "futex_mutex: " << (end - start) << " sec, counter=" << counter << "\n";
+    bench::record("futex_lock_threads", "futex_mutex", "iters=" + std::to_string(ITER), end - start, "sec", bench::LOWER);
 }
 
 // ---------------- Main ----------------
@@ -6,12 +6,14 @@
 #include <iostream>
 #include <sys/mman.h>
 #include <sys/syscall.h>
-#include <linux/futex.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <semaphore.h>
 #include <fcntl.h>
 
+#include "../futex.h"
+#include "../../common/bench_results.h"
+
 constexpr int ITER = 10'000'000;
 
 // ---------------- Timing ----------------
@@ -20,15 +22,6 @@ double now_sec() {
     return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-// ---------------- Futex helpers ----------------
-static inline int futex_wait(std::atomic<int>* addr, int val) {
-    return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
-}
-
-static inline int futex_wake(std::atomic<int>* addr, int n) {
-    return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
-}
-
 // ---------------- Benchmark ----------------
 void benchmark_futex() {
     // Shared memory for futex and counter
@@ -72,6 +65,7 @@ void benchmark_futex() {
     wait(nullptr);
     double end = now_sec();
     std::cout << "Futex: " << (end - start) << " sec, counter=" << shared_futex[1].load() << "\n";
+    bench::record("futex_lock_procs", "futex", "iters=" + std::to_string(ITER), end - start, "sec", bench::LOWER);
     munmap(shared_futex, sizeof(std::atomic<int>)*2);
 }
 
@@ -106,6 +100,7 @@ void benchmark_semaphore() {
     wait(nullptr);
     double end = now_sec();
     std::cout << "POSIX Semaphore: " << (end - start) << " sec, counter=" << *counter << "\n";
+    bench::record("futex_lock_procs", "posix sem", "iters=" + std::to_string(ITER), end - start, "sec", bench::LOWER);
 
     munmap(counter, sizeof(int));
     sem_close(sem);
@@ -3,19 +3,13 @@
 #include <vector>
 #include <atomic>
 #include <chrono>
-#include <linux/futex.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <mutex>
 #include <condition_variable>
 
-static int futex_wait(volatile int* addr, int val) {
-    return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
-}
-
-static int futex_wake(volatile int* addr, int n) {
-    return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
-}
+#include "../futex.h"
+#include "../../common/bench_results.h"
 
 int main(int argc, char** argv) {
     int nthreads = (argc > 1) ? atoi(argv[1]) : 8;
@@ -74,6 +68,8 @@ int main(int argc, char** argv) {
         avg /= latencies.size();
         std::cout << "[FUTEX] Average wake time: " << avg / nthreads
                   << " us/thread (total " << avg << " us)\n";
+        bench::record("futex_wake_threads", "futex", "threads=" + std::to_string(nthreads),
+                      avg / nthreads, "us/thread", bench::LOWER);
     };
 
     //------------------------------------------------------------------
@@ -123,6 +119,8 @@ int main(int argc, char** argv) {
         avg /= latencies.size();
         std::cout << "[PTHREAD] Average wake time: " << avg / nthreads
                   << " us/thread (total " << avg << " us)\n";
+        bench::record("futex_wake_threads", "pthread cond", "threads=" + std::to_string(nthreads),
+                      avg / nthreads, "us/thread", bench::LOWER);
     };
 
     //------------------------------------------------------------------
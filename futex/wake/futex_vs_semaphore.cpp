@@ -7,16 +7,11 @@
 #include <sys/ipc.h>
 #include <sys/sem.h>
 #include <unistd.h>
-#include <linux/futex.h>
 #include <semaphore.h>
 #include <atomic>
 
-static int futex_wait(volatile int* addr, int val) {
-    return syscall(SYS_futex, addr, FUTEX_WAIT, val, nullptr, nullptr, 0);
-}
-static int futex_wake(volatile int* addr, int n) {
-    return syscall(SYS_futex, addr, FUTEX_WAKE, n, nullptr, nullptr, 0);
-}
+#include "../futex.h"
+#include "../../common/bench_results.h"
 
 int main(int argc, char** argv) {
     int nproc  = (argc > 1) ? atoi(argv[1]) : 8;
@@ -66,6 +61,8 @@ int main(int argc, char** argv) {
 
         std::cout << "[FUTEX]   Average wake time: " << avg / nproc
                   << " us/proc (total " << avg << " us)\n";
+        bench::record("futex_wake_procs", "futex", "procs=" + std::to_string(nproc),
+                      avg / nproc, "us/proc", bench::LOWER);
         munmap(futex_val, sizeof(int));
     }
 
@@ -109,6 +106,8 @@ int main(int argc, char** argv) {
 
         std::cout << "[SYSV SEM] Average wake time: " << avg / nproc
                   << " us/proc (total " << avg << " us)\n";
+        bench::record("futex_wake_procs", "sysv sem", "procs=" + std::to_string(nproc),
+                      avg / nproc, "us/proc", bench::LOWER);
         semctl(semid, 0, IPC_RMID);
     }
 
@@ -152,6 +151,8 @@ int main(int argc, char** argv) {
 
         std::cout << "[POSIX SEM] Average wake time: " << avg / nproc
                   << " us/proc (total " << avg << " us)\n";
+        bench::record("futex_wake_procs", "posix sem", "procs=" + std::to_string(nproc),
+                      avg / nproc, "us/proc", bench::LOWER);
 
         sem_destroy(sem);
         munmap(sem, sizeof(sem_t));
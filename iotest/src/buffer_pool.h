@@ -0,0 +1,249 @@
+// buffer_pool.h - aligned, recyclable I/O buffers for O_DIRECT and io_uring
+// fixed-buffer paths.
+//
+//   BufferPool pool(256 << 20);          // 256 MB arena, pre-faulted
+//   void* b = pool.alloc(64 * 1024);     // 4 KB aligned, nullptr if exhausted
+//   ...
+//   pool.free(b);                        // from any thread
+//
+//   auto iov = pool.registration_iovecs();   // one iovec per 2 MB slab
+//   ring.register_buffers(iov.data(), iov.size());
+//   sqe->buf_index = pool.buf_index(b);      // for READ_FIXED / WRITE_FIXED
+//
+// The arena is one 2 MB-aligned anonymous mapping, faulted in up front (with
+// MADV_HUGEPAGE where THP is available). It is carved into 2 MB slabs; a slab
+// is dedicated to one size class (4 KB .. 1 MB, powers of two) and owned by
+// the thread cache that carved it, so free() finds the class and owner from
+// the address alone.
+//
+// Allocation and same-thread free touch only the calling thread's cache.
+// A free from another thread pushes onto the owner's per-class remote stack
+// (lock-free CAS push); the owner takes the whole stack with one exchange
+// when its local list runs dry, so there is no ABA. When a thread exits its
+// cache is parked and adopted by the next thread that uses the pool, keeping
+// the buffers it owns reachable. The pool must outlive its in-flight buffers.
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+class BufferPool {
+public:
+    static constexpr size_t MIN_SIZE = 4096;
+    static constexpr size_t MAX_SIZE = 1024 * 1024;
+    static constexpr size_t SLAB_SIZE = 2 * 1024 * 1024;
+    static constexpr int NUM_CLASSES = 9;  // 4K << 0 .. 4K << 8
+
+    explicit BufferPool(size_t arena_bytes) {
+        num_slabs_ = (arena_bytes + SLAB_SIZE - 1) / SLAB_SIZE;
+        size_t len = num_slabs_ * SLAB_SIZE;
+        // Over-map by one slab so the arena can start on a 2 MB boundary.
+        map_len_ = len + SLAB_SIZE;
+        void* p = mmap(nullptr, map_len_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            map_ = nullptr;
+            num_slabs_ = 0;
+            return;
+        }
+        map_ = static_cast<char*>(p);
+        uintptr_t a = (reinterpret_cast<uintptr_t>(map_) + SLAB_SIZE - 1) & ~(uintptr_t)(SLAB_SIZE - 1);
+        base_ = reinterpret_cast<char*>(a);
+        madvise(base_, len, MADV_HUGEPAGE);
+        for (size_t off = 0; off < len; off += MIN_SIZE) base_[off] = 0;  // pre-fault
+
+        slabs_.reset(new SlabInfo[num_slabs_]);
+        id_ = next_id().fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(registry_mutex());
+        live_pools().insert(id_);
+    }
+
+    ~BufferPool() {
+        {
+            std::lock_guard<std::mutex> lk(registry_mutex());
+            live_pools().erase(id_);
+        }
+        if (map_) munmap(map_, map_len_);
+    }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    bool valid() const { return base_ != nullptr; }
+
+    static int size_class(size_t size) {
+        if (size > MAX_SIZE) return -1;
+        int c = 0;
+        while ((MIN_SIZE << c) < size) ++c;
+        return c;
+    }
+
+    static size_t class_size(int c) { return MIN_SIZE << c; }
+
+    // 4 KB-aligned buffer of at least `size` bytes; nullptr if size exceeds
+    // MAX_SIZE or the arena has no slab left for this class.
+    void* alloc(size_t size) {
+        int c = size_class(size);
+        if (c < 0) return nullptr;
+        Cache* cache = local_cache();
+        FreeNode*& head = cache->local[c];
+        if (!head) {
+            head = cache->remote[c].exchange(nullptr, std::memory_order_acquire);
+            if (!head && !carve(cache, c)) return nullptr;
+        }
+        FreeNode* n = head;
+        head = n->next;
+        return n;
+    }
+
+    void free(void* p) {
+        if (!p) return;
+        const SlabInfo& s = slabs_[slab_of(p)];
+        int c = s.size_class;
+        FreeNode* n = static_cast<FreeNode*>(p);
+        Cache* owner = s.owner;
+        if (owner == local_cache()) {
+            n->next = owner->local[c];
+            owner->local[c] = n;
+            return;
+        }
+        FreeNode* old = owner->remote[c].load(std::memory_order_relaxed);
+        do {
+            n->next = old;
+        } while (!owner->remote[c].compare_exchange_weak(old, n, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+    }
+
+    // One iovec per slab, covering the whole arena; register once up front.
+    std::vector<iovec> registration_iovecs() const {
+        std::vector<iovec> v(num_slabs_);
+        for (size_t i = 0; i < num_slabs_; ++i) v[i] = {base_ + i * SLAB_SIZE, SLAB_SIZE};
+        return v;
+    }
+
+    // Index into registration_iovecs() of the slab containing p.
+    unsigned buf_index(const void* p) const { return static_cast<unsigned>(slab_of(p)); }
+
+    size_t slabs_total() const { return num_slabs_; }
+    size_t slabs_used() const {
+        size_t n = next_slab_.load(std::memory_order_relaxed);
+        return n < num_slabs_ ? n : num_slabs_;
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct Cache {
+        FreeNode* local[NUM_CLASSES] = {};
+        std::atomic<FreeNode*> remote[NUM_CLASSES] = {};
+    };
+
+    struct SlabInfo {
+        Cache* owner = nullptr;
+        int size_class = -1;
+    };
+
+    // Per-thread list of (pool, cache) pairs; on thread exit each cache whose
+    // pool is still alive is parked for adoption.
+    struct ThreadCaches {
+        struct Entry {
+            BufferPool* pool;
+            uint64_t id;
+            Cache* cache;
+        };
+        std::vector<Entry> entries;
+        ~ThreadCaches() {
+            std::lock_guard<std::mutex> lk(registry_mutex());
+            for (const Entry& e : entries) {
+                if (!live_pools().count(e.id)) continue;
+                std::lock_guard<std::mutex> plk(e.pool->mu_);
+                e.pool->orphans_.push_back(e.cache);
+            }
+        }
+    };
+
+    static std::mutex& registry_mutex() {
+        static std::mutex m;
+        return m;
+    }
+    static std::unordered_set<uint64_t>& live_pools() {
+        static std::unordered_set<uint64_t> s;
+        return s;
+    }
+    static std::atomic<uint64_t>& next_id() {
+        static std::atomic<uint64_t> n{1};
+        return n;
+    }
+
+    size_t slab_of(const void* p) const {
+        return static_cast<size_t>(static_cast<const char*>(p) - base_) / SLAB_SIZE;
+    }
+
+    Cache* local_cache() {
+        static thread_local ThreadCaches tc;
+        static thread_local BufferPool* last_pool = nullptr;
+        static thread_local uint64_t last_id = 0;
+        static thread_local Cache* last_cache = nullptr;
+        if (last_pool == this && last_id == id_) return last_cache;
+        for (const auto& e : tc.entries) {
+            if (e.pool == this && e.id == id_) {
+                last_pool = this, last_id = id_, last_cache = e.cache;
+                return e.cache;
+            }
+        }
+        Cache* c;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (!orphans_.empty()) {
+                c = orphans_.back();
+                orphans_.pop_back();
+            } else {
+                caches_.emplace_back(new Cache);
+                c = caches_.back().get();
+            }
+        }
+        tc.entries.push_back({this, id_, c});
+        last_pool = this, last_id = id_, last_cache = c;
+        return c;
+    }
+
+    // Dedicates a fresh slab to class c, owned by `cache`, and threads all of
+    // its buffers onto the local list.
+    bool carve(Cache* cache, int c) {
+        size_t idx = next_slab_.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= num_slabs_) return false;
+        slabs_[idx].owner = cache;
+        slabs_[idx].size_class = c;
+        size_t sz = class_size(c);
+        char* slab = base_ + idx * SLAB_SIZE;
+        FreeNode* head = nullptr;
+        for (size_t off = SLAB_SIZE; off >= sz; off -= sz) {
+            FreeNode* n = reinterpret_cast<FreeNode*>(slab + off - sz);
+            n->next = head;
+            head = n;
+        }
+        cache->local[c] = head;
+        return true;
+    }
+
+    char* map_ = nullptr;
+    size_t map_len_ = 0;
+    char* base_ = nullptr;
+    size_t num_slabs_ = 0;
+    uint64_t id_ = 0;
+    std::unique_ptr<SlabInfo[]> slabs_;
+    std::atomic<size_t> next_slab_{0};
+
+    std::mutex mu_;  // cold path: cache creation and adoption
+    std::vector<std::unique_ptr<Cache>> caches_;
+    std::vector<Cache*> orphans_;
+};
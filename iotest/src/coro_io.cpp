@@ -0,0 +1,420 @@
+// g++ -O2 -std=c++20 coro_io.cpp -o coro_io -lpthread
+// ./coro_io [uring|threadpool]
+//
+// C++20 coroutine port of main.rs: the same 1,000,000 x "hello world\n"
+// cases, with every async write suspended until an executor completes it.
+// The executor is io_uring (default) or, like tokio::fs, a blocking thread
+// pool; if io_uring_setup fails the thread pool is used.
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../common/bench_results.h"
+#include "../../common/uring.h"
+
+using namespace std;
+
+constexpr int ITERATIONS = 1'000'000;
+constexpr char DATA[] = "hello world\n";  // 12 bytes
+constexpr size_t DATA_LEN = sizeof(DATA) - 1;
+constexpr size_t BUF_WRITER_CAPACITY = 8 * 1024;  // tokio/std BufWriter default
+
+// ---------------- Task ----------------
+// Lazily started coroutine; awaiting it runs it and resumes the awaiter when
+// it finishes (symmetric transfer, so long await chains don't grow the stack).
+
+class Task {
+public:
+    struct promise_type {
+        coroutine_handle<> continuation = noop_coroutine();
+
+        Task get_return_object() { return Task{coroutine_handle<promise_type>::from_promise(*this)}; }
+        suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            coroutine_handle<> await_suspend(coroutine_handle<promise_type> h) noexcept {
+                return h.promise().continuation;
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+
+    explicit Task(coroutine_handle<promise_type> h) : h_(h) {}
+    Task(Task&& o) noexcept : h_(exchange(o.h_, {})) {}
+    Task(const Task&) = delete;
+    ~Task() { if (h_) h_.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiter) {
+        h_.promise().continuation = awaiter;
+        return h_;
+    }
+    void await_resume() const noexcept {}
+
+    coroutine_handle<promise_type> handle() const { return h_; }
+
+private:
+    coroutine_handle<promise_type> h_;
+};
+
+// ---------------- Executors ----------------
+
+struct WriteOp;
+
+class Executor {
+public:
+    virtual ~Executor() = default;
+    virtual const char* name() const = 0;
+    virtual void submit(WriteOp* op) = 0;
+    // Waits for at least one completion and resumes its coroutine.
+    virtual void drive() = 0;
+};
+
+// Awaitable pwrite: suspends until the executor has completed it.
+struct WriteOp {
+    Executor* ex;
+    int fd;
+    const char* buf;
+    size_t len;
+    uint64_t offset;
+    int res = 0;
+    coroutine_handle<> waiter;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> h) {
+        waiter = h;
+        ex->submit(this);
+    }
+    int await_resume() const noexcept { return res; }
+};
+
+class UringExecutor : public Executor {
+public:
+    explicit UringExecutor(Uring& ring) : ring_(ring) {}
+    const char* name() const override { return "io_uring"; }
+
+    void submit(WriteOp* op) override {
+        io_uring_sqe* sqe = ring_.get_sqe();
+        while (!sqe) {
+            ring_.submit_and_wait(0);
+            sqe = ring_.get_sqe();
+        }
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = op->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(op->buf);
+        sqe->len = static_cast<uint32_t>(op->len);
+        sqe->off = op->offset;
+        sqe->user_data = reinterpret_cast<uint64_t>(op);
+        ++pending_;
+    }
+
+    void drive() override {
+        int r = ring_.submit_and_wait(1);
+        if (r < 0) { errno = -r; perror("io_uring_enter"); exit(1); }
+        vector<WriteOp*> done;
+        ring_.for_each_cqe([&](const io_uring_cqe& cqe) {
+            auto* op = reinterpret_cast<WriteOp*>(cqe.user_data);
+            op->res = cqe.res;
+            done.push_back(op);
+        });
+        pending_ -= done.size();
+        // Resume after the CQ head has been released: a resumed coroutine may
+        // submit (and drive) again.
+        for (WriteOp* op : done) op->waiter.resume();
+    }
+
+private:
+    Uring& ring_;
+    size_t pending_ = 0;
+};
+
+// Blocking pwrite on worker threads, completions handed back to the thread
+// that drives the coroutines -- the model tokio::fs uses (spawn_blocking).
+class ThreadPoolExecutor : public Executor {
+public:
+    explicit ThreadPoolExecutor(int threads) {
+        for (int i = 0; i < threads; ++i) workers_.emplace_back([this] { worker(); });
+    }
+
+    ~ThreadPoolExecutor() override {
+        {
+            lock_guard<mutex> lk(mu_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    const char* name() const override { return "thread pool"; }
+
+    void submit(WriteOp* op) override {
+        {
+            lock_guard<mutex> lk(mu_);
+            work_.push_back(op);
+        }
+        work_cv_.notify_one();
+    }
+
+    void drive() override {
+        deque<WriteOp*> done;
+        {
+            unique_lock<mutex> lk(mu_);
+            done_cv_.wait(lk, [&] { return !done_.empty(); });
+            done.swap(done_);
+        }
+        for (WriteOp* op : done) op->waiter.resume();
+    }
+
+private:
+    void worker() {
+        for (;;) {
+            WriteOp* op;
+            {
+                unique_lock<mutex> lk(mu_);
+                work_cv_.wait(lk, [&] { return stop_ || !work_.empty(); });
+                if (stop_ && work_.empty()) return;
+                op = work_.front();
+                work_.pop_front();
+            }
+            ssize_t n = pwrite(op->fd, op->buf, op->len, op->offset);
+            op->res = n < 0 ? -errno : static_cast<int>(n);
+            {
+                lock_guard<mutex> lk(mu_);
+                done_.push_back(op);
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    mutex mu_;
+    condition_variable work_cv_;
+    condition_variable done_cv_;
+    deque<WriteOp*> work_;
+    deque<WriteOp*> done_;
+    bool stop_ = false;
+    vector<thread> workers_;
+};
+
+void block_on(Executor& ex, Task task) {
+    task.handle().resume();
+    while (!task.handle().done()) ex.drive();
+}
+
+// ---------------- Async file and BufWriter ----------------
+
+class AsyncFile {
+public:
+    AsyncFile(Executor& ex, const char* path) : ex_(ex) {
+        fd_ = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) { perror("open"); exit(1); }
+    }
+    ~AsyncFile() { close(fd_); }
+
+    WriteOp write_some(const char* buf, size_t len) {
+        return WriteOp{&ex_, fd_, buf, len, pos_, 0, {}};
+    }
+
+    Task write_all(const char* buf, size_t len) {
+        while (len > 0) {
+            int n = co_await write_some(buf, len);
+            if (n < 0) { errno = -n; perror("async write"); exit(1); }
+            pos_ += n;
+            buf += n;
+            len -= n;
+        }
+    }
+
+private:
+    Executor& ex_;
+    int fd_;
+    uint64_t pos_ = 0;
+};
+
+class AsyncBufWriter {
+public:
+    explicit AsyncBufWriter(AsyncFile& f) : file_(f) { buf_.reserve(BUF_WRITER_CAPACITY); }
+
+    Task write_all(const char* data, size_t len) {
+        if (buf_.size() + len > BUF_WRITER_CAPACITY) co_await flush();
+        if (len >= BUF_WRITER_CAPACITY) {
+            co_await file_.write_all(data, len);
+        } else {
+            buf_.insert(buf_.end(), data, data + len);
+        }
+    }
+
+    Task flush() {
+        if (!buf_.empty()) {
+            co_await file_.write_all(buf_.data(), buf_.size());
+            buf_.clear();
+        }
+    }
+
+private:
+    AsyncFile& file_;
+    vector<char> buf_;
+};
+
+// ---------------- Sync counterparts (std::fs) ----------------
+
+void sync_write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) { perror("write"); exit(1); }
+        buf += n;
+        len -= n;
+    }
+}
+
+class SyncBufWriter {
+public:
+    explicit SyncBufWriter(int fd) : fd_(fd) { buf_.reserve(BUF_WRITER_CAPACITY); }
+    void write_all(const char* data, size_t len) {
+        if (buf_.size() + len > BUF_WRITER_CAPACITY) flush();
+        if (len >= BUF_WRITER_CAPACITY) sync_write_all(fd_, data, len);
+        else buf_.insert(buf_.end(), data, data + len);
+    }
+    void flush() {
+        if (!buf_.empty()) sync_write_all(fd_, buf_.data(), buf_.size());
+        buf_.clear();
+    }
+
+private:
+    int fd_;
+    vector<char> buf_;
+};
+
+int open_sync(const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { perror("open"); exit(1); }
+    return fd;
+}
+
+// ---------------- Cases ----------------
+
+const char* g_executor = "";  // recorded with every case
+
+template <class F>
+void timed(const char* label, F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << left << setw(44) << label << right << fixed << setprecision(3) << setw(12) << ms << " ms\n";
+    cout.unsetf(ios::fixed);
+    bench::record("coro_io", label, string("executor=") + g_executor, ms, "ms", bench::LOWER);
+}
+
+int main(int argc, char** argv) {
+    string want = (argc > 1) ? argv[1] : "uring";
+    if (want != "uring" && want != "threadpool") {
+        cerr << "Usage: " << argv[0] << " [uring|threadpool]\n";
+        return 1;
+    }
+
+    unique_ptr<Uring> ring;
+    unique_ptr<Executor> ex;
+    if (want == "uring") {
+        ring = make_unique<Uring>(256);
+        if (ring->valid()) ex = make_unique<UringExecutor>(*ring);
+        else cerr << "io_uring unavailable (" << strerror(ring->error()) << "), using thread pool\n";
+    }
+    if (!ex) ex = make_unique<ThreadPoolExecutor>(4);
+
+    g_executor = ex->name();
+    cout << "Executor: " << ex->name() << ", " << ITERATIONS << " writes of " << DATA_LEN << " bytes\n";
+
+    // As in main.rs, each file is created before its timer starts and closed
+    // after it stops.
+    {
+        AsyncFile file(*ex, "case1_flush_each.log");
+        timed("Case 1: unbuffered async", [&] {
+            block_on(*ex, [&]() -> Task {
+                for (int i = 0; i < ITERATIONS; ++i) co_await file.write_all(DATA, DATA_LEN);
+            }());
+        });
+    }
+
+    {
+        AsyncFile file(*ex, "case1a_flush_each_buffered.log");
+        AsyncBufWriter writer(file);
+        timed("Case 1a: async buffered, flush each", [&] {
+            block_on(*ex, [&]() -> Task {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    co_await writer.write_all(DATA, DATA_LEN);
+                    co_await writer.flush();
+                }
+            }());
+        });
+    }
+
+    {
+        AsyncFile file(*ex, "case1b_flush_once_buffered.log");
+        AsyncBufWriter writer(file);
+        timed("Case 1b: async buffered, flush once", [&] {
+            block_on(*ex, [&]() -> Task {
+                for (int i = 0; i < ITERATIONS; ++i) co_await writer.write_all(DATA, DATA_LEN);
+                co_await writer.flush();
+            }());
+        });
+    }
+
+    {
+        int fd = open_sync("case2_sync_io.log");
+        timed("Case 2: unbuffered sync", [&] {
+            for (int i = 0; i < ITERATIONS; ++i) sync_write_all(fd, DATA, DATA_LEN);
+        });
+        close(fd);
+    }
+
+    {
+        int fd = open_sync("case2a_flush_each_buffered.log");
+        SyncBufWriter writer(fd);
+        timed("Case 2a: sync + BufWriter, flush each", [&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                writer.write_all(DATA, DATA_LEN);
+                writer.flush();
+            }
+        });
+        close(fd);
+    }
+
+    {
+        int fd = open_sync("case2b_flush_once_buffered.log");
+        SyncBufWriter writer(fd);
+        timed("Case 2b: sync + BufWriter, flush once", [&] {
+            for (int i = 0; i < ITERATIONS; ++i) writer.write_all(DATA, DATA_LEN);
+            writer.flush();
+        });
+        close(fd);
+    }
+
+    {
+        AsyncFile file(*ex, "case3_bulk.log");
+        string all;
+        all.reserve(ITERATIONS * DATA_LEN);
+        for (int i = 0; i < ITERATIONS; ++i) all.append(DATA, DATA_LEN);
+        timed("Case 3: single bulk write", [&] {
+            block_on(*ex, [&]() -> Task { co_await file.write_all(all.data(), all.size()); }());
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+// g++ -O2 -std=c++17 parallel_write.cpp -o parallel_write -lpthread
+// ./parallel_write [max_threads] [io_kb] [total_mb]
+//
+// Thread-count sweep for buffered and O_DIRECT writers: N workers either
+// pwrite disjoint regions of one shared file, or each write their own file.
+// Buffered writes to one inode serialize on its i_rwsem, which shows up as
+// flat scaling, rising pwrite latency and voluntary context switches.
+#include <iostream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench_results.h"
+
+using namespace std;
+
+constexpr size_t BLOCK_SIZE = 4096;
+
+constexpr const char* FILE_SHARED = "test_parallel_shared.dat";
+constexpr const char* FILE_PER_THREAD_PREFIX = "test_parallel_thread_";
+
+// Allocate aligned buffer (required for O_DIRECT)
+void* aligned_alloc_block(size_t size) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, BLOCK_SIZE, size) != 0) {
+        cerr << "posix_memalign failed\n";
+        exit(1);
+    }
+    memset(ptr, 'A', size);
+    return ptr;
+}
+
+// Files are preallocated so O_DIRECT writes never extend i_size; extending
+// direct writes take the inode lock exclusively and would hide the
+// buffered-vs-direct difference.
+int open_target(const char* filename, bool direct, size_t size) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | (direct ? O_DIRECT : 0);
+    int fd = open(filename, flags, 0666);
+    if (fd < 0) { perror("open"); exit(1); }
+    if (fallocate(fd, 0, 0, size) < 0) { perror("fallocate"); exit(1); }
+    return fd;
+}
+
+struct WorkerStats {
+    double pwrite_us_total = 0;
+    double pwrite_us_max = 0;
+    size_t calls = 0;
+};
+
+void write_region(int fd, const char* buf, size_t io_size, off_t base, size_t len, WorkerStats* st) {
+    for (size_t off = 0; off < len; off += io_size) {
+        auto t0 = chrono::steady_clock::now();
+        ssize_t n = pwrite(fd, buf, io_size, base + off);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+        if (n != (ssize_t)io_size) { perror("pwrite"); exit(1); }
+        st->pwrite_us_total += us;
+        st->pwrite_us_max = max(st->pwrite_us_max, us);
+        st->calls++;
+    }
+}
+
+struct SweepResult {
+    double sec;
+    size_t bytes;  // region * nthreads: the remainder of total_size is not written
+    double avg_pwrite_us;
+    double max_pwrite_us;
+    long vol_ctx;
+    long invol_ctx;
+};
+
+SweepResult run(int nthreads, bool shared, bool direct, size_t io_size, size_t total_size) {
+    const size_t region = total_size / nthreads / io_size * io_size;
+    vector<int> fds;
+    if (shared) {
+        fds.push_back(open_target(FILE_SHARED, direct, region * nthreads));
+    } else {
+        for (int t = 0; t < nthreads; ++t) {
+            string name = FILE_PER_THREAD_PREFIX + to_string(t) + ".dat";
+            fds.push_back(open_target(name.c_str(), direct, region));
+        }
+    }
+
+    char* buf = (char*)aligned_alloc_block(io_size);
+    vector<WorkerStats> stats(nthreads);
+    atomic<bool> go{false};
+    vector<thread> workers;
+    for (int t = 0; t < nthreads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            if (shared) {
+                write_region(fds[0], buf, io_size, (off_t)t * region, region, &stats[t]);
+            } else {
+                write_region(fds[t], buf, io_size, 0, region, &stats[t]);
+                fsync(fds[t]);
+            }
+        });
+    }
+
+    rusage before{}, after{};
+    getrusage(RUSAGE_SELF, &before);
+    auto start = chrono::high_resolution_clock::now();
+    go.store(true, memory_order_release);
+    for (auto& w : workers) w.join();
+    if (shared) fsync(fds[0]);
+    auto end = chrono::high_resolution_clock::now();
+    getrusage(RUSAGE_SELF, &after);
+
+    for (int fd : fds) close(fd);
+    unlink(FILE_SHARED);
+    for (int t = 0; t < nthreads; ++t)
+        unlink((FILE_PER_THREAD_PREFIX + to_string(t) + ".dat").c_str());
+    free(buf);
+
+    SweepResult r{chrono::duration<double>(end - start).count(), region * nthreads, 0, 0,
+                  after.ru_nvcsw - before.ru_nvcsw, after.ru_nivcsw - before.ru_nivcsw};
+    size_t calls = 0;
+    for (auto& s : stats) {
+        r.avg_pwrite_us += s.pwrite_us_total;
+        r.max_pwrite_us = max(r.max_pwrite_us, s.pwrite_us_max);
+        calls += s.calls;
+    }
+    r.avg_pwrite_us /= calls;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : 16;
+    size_t io_size = (argc > 2) ? strtoull(argv[2], nullptr, 10) * 1024 : 64 * 1024;
+    size_t total_size = (argc > 3) ? strtoull(argv[3], nullptr, 10) * 1024 * 1024 : 1024ULL * 1024 * 1024;
+
+    if (max_threads <= 0 || io_size == 0 || io_size % BLOCK_SIZE != 0 || total_size < io_size) {
+        cerr << "Usage: " << argv[0] << " [max_threads] [io_kb (multiple of 4)] [total_mb]\n";
+        return 1;
+    }
+
+    cout << "Parallel writers: " << total_size / (1024 * 1024) << " MB total, "
+         << io_size / 1024 << " KB pwrite, up to " << max_threads << " threads\n";
+    cout << left << setw(20) << "Mode" << right << setw(8) << "Threads"
+         << setw(10) << "GB/s" << setw(14) << "avg pwrite us" << setw(14) << "max pwrite us"
+         << setw(10) << "vol csw" << setw(10) << "invol csw" << "\n";
+
+    for (bool direct : {false, true}) {
+        for (bool shared : {true, false}) {
+            string mode = string(direct ? "direct" : "buffered") + (shared ? " shared" : " per-file");
+            for (int n = 1; n <= max_threads; n *= 2) {
+                if (total_size / n < io_size) {
+                    cout << left << setw(20) << mode << right << setw(8) << n
+                         << "  skipped: less than one " << io_size / 1024 << " KB write per thread\n";
+                    continue;
+                }
+                SweepResult r = run(n, shared, direct, io_size, total_size);
+                const double gbps = r.bytes / r.sec / 1e9;
+                cout << left << setw(20) << mode << right << setw(8) << n
+                     << fixed << setprecision(2)
+                     << setw(10) << gbps
+                     << setprecision(1)
+                     << setw(14) << r.avg_pwrite_us
+                     << setw(14) << r.max_pwrite_us
+                     << setw(10) << r.vol_ctx
+                     << setw(10) << r.invol_ctx << "\n";
+                cout.unsetf(ios::fixed);
+                const string params = "threads=" + to_string(n) + " io=" + to_string(io_size / 1024) + "K" +
+                                      " total_mb=" + to_string(total_size / (1024 * 1024));
+                bench::record("parallel_write", mode, params, gbps, "GB/s", bench::HIGHER);
+                bench::record("parallel_write", mode + " max pwrite", params, r.max_pwrite_us, "us", bench::LOWER);
+            }
+        }
+    }
+    return 0;
+}
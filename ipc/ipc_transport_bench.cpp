@@ -0,0 +1,320 @@
+// ipc_transport_bench.cpp
+// Build: g++ -O2 -std=c++17 ipc_transport_bench.cpp -o ipc_transport_bench
+// Run:   ./ipc_transport_bench [total_mb] [pingpong_iters]
+//        e.g. ./ipc_transport_bench 64 20000
+//
+// Parent and forked child talk over loopback TCP, AF_UNIX stream and
+// seqpacket sockets, a pair of pipes, and a shared-memory SPSC byte ring with
+// futex wakeup. For each message size: one-way streaming throughput, and
+// one-way latency as half of a ping-pong round trip.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../futex/futex.h"
+#include "../common/bench_results.h"
+
+constexpr size_t MSG_SIZES[] = {64, 1024, 16 << 10, 64 << 10};
+constexpr size_t RING_CAPACITY = 1 << 20;  // bytes, power of two
+constexpr int    SPIN_LIMIT = 200;         // polls before sleeping on the futex
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// ---------------- Links ----------------
+// A Link is one endpoint of a bidirectional byte channel.
+
+class Link {
+public:
+    virtual ~Link() = default;
+    virtual void send(const char* data, size_t len) = 0;
+    virtual void recv(char* data, size_t len) = 0;
+};
+
+class FdLink : public Link {
+public:
+    FdLink(int rfd, int wfd) : rfd_(rfd), wfd_(wfd) {}
+    ~FdLink() override {
+        ::close(rfd_);
+        if (wfd_ != rfd_) ::close(wfd_);
+    }
+
+    void send(const char* data, size_t len) override {
+        size_t off = 0;
+        while (off < len) {
+            ssize_t n = ::write(wfd_, data + off, len - off);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("write");
+                std::exit(1);
+            }
+            off += static_cast<size_t>(n);
+        }
+    }
+
+    void recv(char* data, size_t len) override {
+        size_t off = 0;
+        while (off < len) {
+            ssize_t n = ::read(rfd_, data + off, len - off);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("read");
+                std::exit(1);
+            }
+            if (n == 0) { std::cerr << "read: unexpected EOF\n"; std::exit(1); }
+            off += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int rfd_;
+    int wfd_;
+};
+
+// Single-producer/single-consumer byte ring in MAP_SHARED memory. head and
+// tail are free-running byte counters; each side sleeps on a futex sequence
+// word only after spinning, and the other side wakes it only when its
+// *_waiting flag is set, so the streaming fast path makes no syscalls.
+struct ShmRing {
+    alignas(64) std::atomic<uint64_t> head;   // consumer position
+    alignas(64) std::atomic<uint64_t> tail;   // producer position
+    alignas(64) std::atomic<int> data_seq;    // bumped when data is published to a sleeper
+    std::atomic<int> consumer_waiting;
+    alignas(64) std::atomic<int> space_seq;   // bumped when space is freed for a sleeper
+    std::atomic<int> producer_waiting;
+    alignas(64) char data[RING_CAPACITY];
+};
+
+template <class Ready>
+static void wait_until(Ready ready, std::atomic<int>& seq, std::atomic<int>& waiting) {
+    for (int i = 0; i < SPIN_LIMIT; ++i) {
+        if (ready()) return;
+        cpu_relax();
+    }
+    while (!ready()) {
+        int s = seq.load(std::memory_order_acquire);
+        waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with notify()
+        if (ready()) break;
+        futex_wait(&seq, s);
+    }
+    waiting.store(0, std::memory_order_relaxed);
+}
+
+static void notify(std::atomic<int>& seq, std::atomic<int>& waiting) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // publish before checking waiter
+    if (waiting.load(std::memory_order_relaxed)) {
+        seq.fetch_add(1, std::memory_order_release);
+        futex_wake(&seq, 1);
+    }
+}
+
+static void ring_write(ShmRing* r, const char* data, size_t len) {
+    uint64_t tail = r->tail.load(std::memory_order_relaxed);
+    while (len > 0) {
+        auto has_space = [&] { return tail - r->head.load(std::memory_order_acquire) < RING_CAPACITY; };
+        wait_until(has_space, r->space_seq, r->producer_waiting);
+        size_t free_bytes = RING_CAPACITY - (tail - r->head.load(std::memory_order_acquire));
+        size_t pos = tail & (RING_CAPACITY - 1);
+        size_t n = std::min({len, free_bytes, RING_CAPACITY - pos});
+        std::memcpy(r->data + pos, data, n);
+        tail += n;
+        data += n;
+        len -= n;
+        r->tail.store(tail, std::memory_order_release);
+        notify(r->data_seq, r->consumer_waiting);
+    }
+}
+
+static void ring_read(ShmRing* r, char* data, size_t len) {
+    uint64_t head = r->head.load(std::memory_order_relaxed);
+    while (len > 0) {
+        auto has_data = [&] { return r->tail.load(std::memory_order_acquire) != head; };
+        wait_until(has_data, r->data_seq, r->consumer_waiting);
+        size_t avail = r->tail.load(std::memory_order_acquire) - head;
+        size_t pos = head & (RING_CAPACITY - 1);
+        size_t n = std::min({len, avail, RING_CAPACITY - pos});
+        std::memcpy(data, r->data + pos, n);
+        head += n;
+        data += n;
+        len -= n;
+        r->head.store(head, std::memory_order_release);
+        notify(r->space_seq, r->producer_waiting);
+    }
+}
+
+// Both endpoints share the two-ring mapping; the last one to go unmaps it.
+class ShmLink : public Link {
+public:
+    ShmLink(std::shared_ptr<ShmRing> rings, int tx, int rx)
+        : rings_(std::move(rings)), tx_(&rings_.get()[tx]), rx_(&rings_.get()[rx]) {}
+    void send(const char* data, size_t len) override { ring_write(tx_, data, len); }
+    void recv(char* data, size_t len) override { ring_read(rx_, data, len); }
+
+private:
+    std::shared_ptr<ShmRing> rings_;
+    ShmRing* tx_;
+    ShmRing* rx_;
+};
+
+// ---------------- Transport setup ----------------
+// Each factory returns {parent endpoint, child endpoint}; the forked child
+// drops the parent endpoint and vice versa.
+
+using LinkPair = std::pair<std::unique_ptr<Link>, std::unique_ptr<Link>>;
+
+static LinkPair make_tcp() {
+    int lfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0) { perror("socket"); std::exit(1); }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t alen = sizeof(addr);
+    if (::bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); std::exit(1); }
+    if (::listen(lfd, 1) < 0) { perror("listen"); std::exit(1); }
+    ::getsockname(lfd, (sockaddr*)&addr, &alen);
+
+    int cfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(cfd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("connect"); std::exit(1); }
+    int afd = ::accept(lfd, nullptr, nullptr);
+    if (afd < 0) { perror("accept"); std::exit(1); }
+    ::close(lfd);
+
+    int one = 1;
+    ::setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ::setsockopt(afd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return {std::make_unique<FdLink>(cfd, cfd), std::make_unique<FdLink>(afd, afd)};
+}
+
+static LinkPair make_unix(int type) {
+    int sv[2];
+    if (::socketpair(AF_UNIX, type, 0, sv) < 0) { perror("socketpair"); std::exit(1); }
+    return {std::make_unique<FdLink>(sv[0], sv[0]), std::make_unique<FdLink>(sv[1], sv[1])};
+}
+
+static LinkPair make_pipe() {
+    int down[2], up[2];
+    if (::pipe(down) < 0 || ::pipe(up) < 0) { perror("pipe"); std::exit(1); }
+    // parent writes down[1] / reads up[0]; child reads down[0] / writes up[1]
+    auto parent = std::make_unique<FdLink>(up[0], down[1]);
+    auto child  = std::make_unique<FdLink>(down[0], up[1]);
+    return {std::move(parent), std::move(child)};
+}
+
+static LinkPair make_shm() {
+    void* mem = ::mmap(nullptr, 2 * sizeof(ShmRing), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) { perror("mmap"); std::exit(1); }
+    // zero-filled: all counters start at 0
+    std::shared_ptr<ShmRing> rings(static_cast<ShmRing*>(mem),
+                                   [](ShmRing* p) { ::munmap(p, 2 * sizeof(ShmRing)); });
+    return {std::make_unique<ShmLink>(rings, 0, 1), std::make_unique<ShmLink>(rings, 1, 0)};
+}
+
+// ---------------- Benchmark ----------------
+
+struct Result {
+    double mb_per_sec;
+    double msgs_per_sec;
+    double one_way_us;
+};
+
+static Result run(const std::string& name, size_t msg_size, size_t total_bytes, int iters) {
+    LinkPair links;
+    if (name == "tcp")            links = make_tcp();
+    else if (name == "unix")      links = make_unix(SOCK_STREAM);
+    else if (name == "seqpacket") links = make_unix(SOCK_SEQPACKET);
+    else if (name == "pipe")      links = make_pipe();
+    else                          links = make_shm();
+
+    const size_t count = std::max<size_t>(1, total_bytes / msg_size);
+    std::vector<char> buf(msg_size, 'x');
+    char ack = 0;
+
+    pid_t pid = ::fork();
+    if (pid < 0) { perror("fork"); std::exit(1); }
+    if (pid == 0) {
+        links.first.reset();
+        Link& l = *links.second;
+        for (size_t i = 0; i < count; ++i) l.recv(buf.data(), msg_size);
+        l.send(&ack, 1);
+        for (int i = 0; i < iters; ++i) {
+            l.recv(buf.data(), msg_size);
+            l.send(buf.data(), msg_size);
+        }
+        links.second.reset();
+        _exit(0);
+    }
+    links.second.reset();
+    Link& l = *links.first;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) l.send(buf.data(), msg_size);
+    l.recv(&ack, 1);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) {
+        l.send(buf.data(), msg_size);
+        l.recv(buf.data(), msg_size);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    links.first.reset();
+    ::waitpid(pid, nullptr, 0);
+
+    double stream_sec = std::chrono::duration<double>(t1 - t0).count();
+    double pp_sec = std::chrono::duration<double>(t2 - t1).count();
+    return {count * msg_size / (1024.0 * 1024.0) / stream_sec,
+            count / stream_sec,
+            pp_sec * 1e6 / iters / 2.0};
+}
+
+int main(int argc, char** argv) {
+    const size_t total_mb = (argc > 1) ? static_cast<size_t>(std::stoull(argv[1])) : 64;
+    const int iters = (argc > 2) ? std::stoi(argv[2]) : 20000;
+    const char* transports[] = {"tcp", "unix", "seqpacket", "pipe", "shm"};
+
+    std::cout << "Streaming " << total_mb << " MB per size, " << iters << " ping-pong round trips\n";
+    std::cout << std::left << std::setw(11) << "Transport"
+              << std::right << std::setw(8) << "Size"
+              << std::setw(12) << "MB/s"
+              << std::setw(14) << "msgs/s"
+              << std::setw(14) << "one-way us" << "\n";
+
+    for (const char* t : transports) {
+        for (size_t size : MSG_SIZES) {
+            Result r = run(t, size, total_mb << 20, iters);
+            std::cout << std::left << std::setw(11) << t
+                      << std::right << std::setw(8) << size
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << r.mb_per_sec
+                      << std::setprecision(0)
+                      << std::setw(14) << r.msgs_per_sec
+                      << std::setprecision(2)
+                      << std::setw(14) << r.one_way_us << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            const std::string params = "size=" + std::to_string(size);
+            bench::record("ipc_transport", std::string(t) + " stream", params, r.mb_per_sec, "MB/s", bench::HIGHER);
+            bench::record("ipc_transport", std::string(t) + " one-way", params, r.one_way_us, "us", bench::LOWER);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,334 @@
+// async_logger.h - asynchronous binary logger: per-thread SPSC rings drained
+// by one background thread with a writev per batch.
+//
+//   AsyncLogger log("app.log");
+//   log.logf("order id=%d px=%.2f\n", id, px);   // any thread, no lock, no syscall
+//   log.log(bytes, len);                          // pre-encoded binary payload
+//   log.flush();                                  // everything logged so far is written
+//
+// Each calling thread gets its own byte ring on first use. A record is a
+// 16-byte RecordHeader (payload length, thread slot, monotonic ns) followed by
+// the payload, padded to 8 bytes; it is built in place in the ring (logf
+// formats straight into it) and published with one release store. The
+// background thread gathers the committed span of every ring into iovecs and
+// emits them with one writev, so the file is the concatenation of records
+// exactly as they sat in the rings (read it back with for_each_record).
+//
+// A full ring makes the producer spin-yield until the drainer frees space
+// (stalls() counts these); the drainer polls with a short sleep when idle, so
+// producers never make a syscall to wake it. Rings of exited threads are
+// reused by new threads once drained. The logger must outlive its threads'
+// last log call.
+#pragma once
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct RecordHeader {
+    uint32_t len;   // payload bytes (PAD_MARKER: skip to the ring start)
+    uint32_t slot;  // ring index of the producing thread
+    uint64_t ns;    // steady_clock timestamp
+};
+
+class AsyncLogger {
+public:
+    static constexpr size_t RING_BYTES = 1 << 20;  // per thread, power of two
+    static constexpr size_t MAX_RINGS = 256;
+    static constexpr size_t MAX_RECORD = 4096;     // payload limit for logf
+    static constexpr uint32_t PAD_MARKER = UINT32_MAX;
+
+    explicit AsyncLogger(const char* path) {
+        fd_ = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) { perror("open log"); exit(1); }
+        id_ = next_id().fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lk(registry_mutex());
+            live_loggers().insert(id_);
+        }
+        drainer_ = std::thread([this] { drain_loop(); });
+    }
+
+    ~AsyncLogger() {
+        {
+            std::lock_guard<std::mutex> lk(registry_mutex());
+            live_loggers().erase(id_);
+        }
+        stop_.store(true, std::memory_order_release);
+        drainer_.join();
+        drain_once();  // anything committed after the drainer's last pass
+        ::close(fd_);
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Payloads longer than MAX_RECORD are truncated.
+    void log(const void* data, size_t len) {
+        len = std::min(len, MAX_RECORD);
+        Ring* r = local_ring();
+        char* p = reserve(r, len);
+        std::memcpy(p + sizeof(RecordHeader), data, len);
+        commit(r, p, len);
+    }
+
+    __attribute__((format(printf, 2, 3))) void logf(const char* fmt, ...) {
+        Ring* r = local_ring();
+        char* p = reserve(r, MAX_RECORD);
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(p + sizeof(RecordHeader), MAX_RECORD, fmt, ap);
+        va_end(ap);
+        size_t len = n < 0 ? 0 : (static_cast<size_t>(n) < MAX_RECORD ? n : MAX_RECORD - 1);
+        commit(r, p, len);
+    }
+
+    // Blocks until every record committed before the call is in the file.
+    void flush() {
+        size_t n = nrings_.load(std::memory_order_acquire);
+        std::vector<uint64_t> target(n);
+        for (size_t i = 0; i < n; ++i) target[i] = rings_[i]->head.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i)
+            while (rings_[i]->tail.load(std::memory_order_acquire) < target[i]) std::this_thread::yield();
+    }
+
+    uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+    uint64_t writev_calls() const { return writev_calls_.load(std::memory_order_relaxed); }
+
+    // Calls f(header, payload) for each record in a file written by AsyncLogger.
+    template <class F>
+    static bool for_each_record(const char* path, F&& f) {
+        FILE* in = fopen(path, "rb");
+        if (!in) return false;
+        std::vector<char> payload;
+        RecordHeader h;
+        bool ok = true;
+        while (fread(&h, sizeof(h), 1, in) == 1) {
+            size_t padded = round_up(h.len);
+            if (h.len == PAD_MARKER || padded > MAX_RECORD + 8) { ok = false; break; }
+            payload.resize(padded);
+            if (padded && fread(payload.data(), 1, padded, in) != padded) { ok = false; break; }
+            f(h, payload.data());
+        }
+        fclose(in);
+        return ok;
+    }
+
+private:
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head{0};  // producer: bytes committed
+        char pad0[56];
+        std::atomic<uint64_t> tail{0};  // drainer: bytes written out
+        char pad1[56];
+        uint64_t cached_tail = 0;       // producer's last view of tail
+        uint64_t pending = 0;           // drainer: head covered by the batch in flight
+        uint32_t slot = 0;
+        std::unique_ptr<char[]> buf{new char[RING_BYTES]};
+    };
+
+    static size_t round_up(size_t n) { return (n + 7) & ~size_t(7); }
+
+    // Space for header + len payload bytes, contiguous in the ring; a record
+    // that would straddle the end leaves a pad marker and starts at offset 0.
+    char* reserve(Ring* r, size_t len) {
+        const size_t need = sizeof(RecordHeader) + round_up(len);
+        uint64_t head = r->head.load(std::memory_order_relaxed);
+        size_t off = head & (RING_BYTES - 1);
+        size_t skip = (RING_BYTES - off < need) ? RING_BYTES - off : 0;
+        if (head + skip + need - r->cached_tail > RING_BYTES) {
+            r->cached_tail = r->tail.load(std::memory_order_acquire);
+            if (head + skip + need - r->cached_tail > RING_BYTES) {
+                stalls_.fetch_add(1, std::memory_order_relaxed);
+                do {
+                    std::this_thread::yield();
+                    r->cached_tail = r->tail.load(std::memory_order_acquire);
+                } while (head + skip + need - r->cached_tail > RING_BYTES);
+            }
+        }
+        if (skip) {
+            // The marker needs 4 bytes; offsets are 8-aligned so it always fits.
+            uint32_t marker = PAD_MARKER;
+            std::memcpy(r->buf.get() + off, &marker, sizeof(marker));
+            r->head.store(head + skip, std::memory_order_release);
+            off = 0;
+        }
+        return r->buf.get() + off;
+    }
+
+    void commit(Ring* r, char* p, size_t len) {
+        RecordHeader h{static_cast<uint32_t>(len), r->slot,
+                       static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())};
+        std::memcpy(p, &h, sizeof(h));
+        uint64_t head = r->head.load(std::memory_order_relaxed);
+        r->head.store(head + sizeof(RecordHeader) + round_up(len), std::memory_order_release);
+    }
+
+    // Gathers the committed bytes of every ring and writes them with one writev
+    // (or a few, past IOV_MAX). Returns the bytes written.
+    size_t drain_once() {
+        const size_t n = nrings_.load(std::memory_order_acquire);
+        iov_.clear();
+        touched_.clear();
+        for (size_t i = 0; i < n; ++i) {
+            Ring* r = rings_[i];
+            uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            uint64_t head = r->head.load(std::memory_order_acquire);
+            if (head == tail) continue;
+            r->pending = head;
+            touched_.push_back(r);
+            while (tail < head) {
+                size_t off = tail & (RING_BYTES - 1);
+                size_t run = std::min<uint64_t>(head - tail, RING_BYTES - off);
+                // Stop a segment at a pad marker and skip the rest of the ring.
+                size_t seg = 0;
+                while (seg < run) {
+                    uint32_t len;
+                    std::memcpy(&len, r->buf.get() + off + seg, sizeof(len));
+                    if (len == PAD_MARKER) break;
+                    seg += sizeof(RecordHeader) + round_up(len);
+                }
+                if (seg) iov_.push_back({r->buf.get() + off, seg});
+                tail += (seg < run) ? RING_BYTES - off : seg;
+            }
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < iov_.size(); i += IOV_MAX) {
+            size_t cnt = std::min<size_t>(IOV_MAX, iov_.size() - i);
+            total += writev_all(iov_.data() + i, cnt);
+        }
+        for (Ring* r : touched_) r->tail.store(r->pending, std::memory_order_release);
+        return total;
+    }
+
+    size_t writev_all(iovec* iov, size_t cnt) {
+        size_t total = 0;
+        while (cnt > 0) {
+            ssize_t w = ::writev(fd_, iov, static_cast<int>(cnt));
+            writev_calls_.fetch_add(1, std::memory_order_relaxed);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                perror("writev");
+                exit(1);
+            }
+            total += w;
+            while (cnt > 0 && static_cast<size_t>(w) >= iov->iov_len) {
+                w -= iov->iov_len;
+                ++iov;
+                --cnt;
+            }
+            if (cnt > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + w;
+                iov->iov_len -= w;
+            }
+        }
+        return total;
+    }
+
+    void drain_loop() {
+        int idle = 0;
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (drain_once()) {
+                idle = 0;
+            } else if (++idle < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    // ---------------- Per-thread ring registration ----------------
+
+    struct ThreadRings {
+        struct Entry {
+            AsyncLogger* logger;
+            uint64_t id;
+            Ring* ring;
+        };
+        std::vector<Entry> entries;
+        ~ThreadRings() {
+            std::lock_guard<std::mutex> lk(registry_mutex());
+            for (const Entry& e : entries) {
+                if (!live_loggers().count(e.id)) continue;
+                std::lock_guard<std::mutex> llk(e.logger->mu_);
+                e.logger->free_rings_.push_back(e.ring);
+            }
+        }
+    };
+
+    static std::mutex& registry_mutex() {
+        static std::mutex m;
+        return m;
+    }
+    static std::unordered_set<uint64_t>& live_loggers() {
+        static std::unordered_set<uint64_t> s;
+        return s;
+    }
+    static std::atomic<uint64_t>& next_id() {
+        static std::atomic<uint64_t> n{1};
+        return n;
+    }
+
+    Ring* local_ring() {
+        static thread_local ThreadRings tr;
+        static thread_local uint64_t last_id = 0;
+        static thread_local Ring* last_ring = nullptr;
+        if (last_id == id_) return last_ring;
+        for (const auto& e : tr.entries) {
+            if (e.logger == this && e.id == id_) {
+                last_id = id_, last_ring = e.ring;
+                return e.ring;
+            }
+        }
+        Ring* r;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (!free_rings_.empty()) {
+                // A reused ring keeps its head/tail; the drainer simply continues.
+                r = free_rings_.back();
+                free_rings_.pop_back();
+            } else {
+                size_t n = nrings_.load(std::memory_order_relaxed);
+                if (n == MAX_RINGS) { fprintf(stderr, "AsyncLogger: more than %zu threads\n", MAX_RINGS); exit(1); }
+                r = new Ring;
+                r->slot = static_cast<uint32_t>(n);
+                rings_[n] = r;
+                owned_.emplace_back(r);
+                nrings_.store(n + 1, std::memory_order_release);
+            }
+        }
+        tr.entries.push_back({this, id_, r});
+        last_id = id_, last_ring = r;
+        return r;
+    }
+
+    int fd_ = -1;
+    uint64_t id_ = 0;
+    Ring* rings_[MAX_RINGS] = {};
+    std::atomic<size_t> nrings_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> writev_calls_{0};
+    std::thread drainer_;
+    std::vector<iovec> iov_;      // drainer only
+    std::vector<Ring*> touched_;  // drainer only
+
+    std::mutex mu_;  // cold path: ring creation and reuse
+    std::vector<std::unique_ptr<Ring>> owned_;
+    std::vector<Ring*> free_rings_;
+};
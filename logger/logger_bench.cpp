@@ -0,0 +1,199 @@
+// g++ -O2 -std=c++17 logger_bench.cpp -o logger_bench -lpthread
+// ./logger_bench [max_threads] [records_per_thread]
+//
+// Caller-side latency and sustained throughput of AsyncLogger versus two
+// synchronous baselines, for 1..max_threads logging threads:
+//   mutex+fprintf: std::mutex around fprintf to a buffered FILE*;
+//   mutex+write:   std::mutex around snprintf + write(2) per record;
+//   async:         AsyncLogger::logf (per-thread ring, background writev).
+// Every call is timed individually; records/s runs until the last record is
+// in the file (fflush / logger flush included). Each log file is read back
+// and every thread's sequence numbers checked.
+#include <iostream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_logger.h"
+#include "../common/bench_results.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+constexpr const char* LOG_FPRINTF = "test_log_fprintf.log";
+constexpr const char* LOG_WRITE = "test_log_write.log";
+constexpr const char* LOG_ASYNC = "test_log_async.log";
+
+// One line of an order-flow log: ~60 bytes, a few conversions.
+#define LOG_FMT "tid=%d seq=%llu px=%.2f qty=%d side=%s\n"
+#define LOG_ARGS(t, i) t, (unsigned long long)(i), 100.0 + (i % 1000) * 0.01, (int)(i % 500), (i & 1) ? "buy" : "sell"
+
+struct Result {
+    double records_per_sec;
+    double p50_ns, p99_ns, p999_ns, max_ns;
+};
+
+double percentile(vector<double>& v, double q) {
+    size_t k = min(v.size() - 1, static_cast<size_t>(q * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// Runs `call(thread, seq)` records_per_thread times on each thread; `finish`
+// makes everything durable in the page cache before the clock stops.
+Result run(int nthreads, size_t per_thread, const function<void(int, uint64_t)>& call,
+           const function<void()>& finish) {
+    vector<vector<double>> lat(nthreads, vector<double>(per_thread));
+    atomic<bool> go{false};
+    vector<thread> workers;
+    for (int t = 0; t < nthreads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            vector<double>& l = lat[t];
+            for (size_t i = 0; i < per_thread; ++i) {
+                auto t0 = Clock::now();
+                call(t, i);
+                l[i] = chrono::duration<double, nano>(Clock::now() - t0).count();
+            }
+        });
+    }
+    auto start = Clock::now();
+    go.store(true, memory_order_release);
+    for (auto& w : workers) w.join();
+    finish();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all;
+    all.reserve(nthreads * per_thread);
+    for (auto& l : lat) all.insert(all.end(), l.begin(), l.end());
+    Result r{nthreads * per_thread / sec, 0, 0, 0, 0};
+    r.p50_ns = percentile(all, 0.50);
+    r.p99_ns = percentile(all, 0.99);
+    r.p999_ns = percentile(all, 0.999);
+    r.max_ns = *max_element(all.begin(), all.end());
+    return r;
+}
+
+// Checks that each thread's "tid=T seq=N" lines appear with N = 0, 1, 2, ...
+struct SeqCheck {
+    vector<uint64_t> next;
+    bool ok = true;
+    explicit SeqCheck(int nthreads) : next(nthreads, 0) {}
+    void line(const char* s) {
+        int tid;
+        unsigned long long seq;
+        if (sscanf(s, "tid=%d seq=%llu", &tid, &seq) != 2 || tid < 0 || tid >= (int)next.size() ||
+            seq != next[tid]++)
+            ok = false;
+    }
+    bool complete(size_t per_thread) const {
+        for (uint64_t n : next)
+            if (n != per_thread) return false;
+        return ok;
+    }
+};
+
+bool verify_text(const char* path, int nthreads, size_t per_thread) {
+    FILE* in = fopen(path, "r");
+    if (!in) return false;
+    SeqCheck check(nthreads);
+    char line[256];
+    while (fgets(line, sizeof(line), in)) check.line(line);
+    fclose(in);
+    return check.complete(per_thread);
+}
+
+bool verify_async(const char* path, int nthreads, size_t per_thread) {
+    SeqCheck check(nthreads);
+    bool ok = AsyncLogger::for_each_record(path, [&](const RecordHeader&, const char* payload) {
+        check.line(payload);
+    });
+    return ok && check.complete(per_thread);
+}
+
+void print_row(const char* mode, int nthreads, const Result& r, bool ok, const string& extra) {
+    cout << left << setw(15) << mode << right << setw(8) << nthreads
+         << fixed << setprecision(0) << setw(14) << r.records_per_sec
+         << setw(10) << r.p50_ns << setw(10) << r.p99_ns << setw(11) << r.p999_ns
+         << setw(12) << r.max_ns << setw(6) << (ok ? "ok" : "BAD") << "  " << extra << "\n";
+    cout.unsetf(ios::fixed);
+    const string params = "threads=" + to_string(nthreads);
+    bench::record("logger", mode, params, r.records_per_sec, "records/s", bench::HIGHER);
+    bench::record("logger", string(mode) + " p99", params, r.p99_ns, "ns", bench::LOWER);
+}
+
+int main(int argc, char** argv) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : 8;
+    size_t per_thread = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 200000;
+    if (max_threads <= 0 || per_thread == 0) {
+        cerr << "Usage: " << argv[0] << " [max_threads] [records_per_thread]\n";
+        return 1;
+    }
+
+    cout << "Logging " << per_thread << " records/thread, ~60 bytes each\n";
+    cout << left << setw(15) << "Mode" << right << setw(8) << "Threads" << setw(14) << "records/s"
+         << setw(10) << "p50 ns" << setw(10) << "p99 ns" << setw(11) << "p99.9 ns" << setw(12) << "max ns"
+         << setw(6) << "file" << "\n";
+
+    int rc = 0;
+    for (int n = 1; n <= max_threads; n *= 2) {
+        {
+            FILE* f = fopen(LOG_FPRINTF, "w");
+            if (!f) { perror("fopen"); return 1; }
+            mutex mu;
+            Result r = run(n, per_thread, [&](int t, uint64_t i) {
+                lock_guard<mutex> lk(mu);
+                fprintf(f, LOG_FMT, LOG_ARGS(t, i));
+            }, [&] { fflush(f); });
+            fclose(f);
+            bool ok = verify_text(LOG_FPRINTF, n, per_thread);
+            rc |= !ok;
+            print_row("mutex+fprintf", n, r, ok, "");
+        }
+        {
+            int fd = open(LOG_WRITE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) { perror("open"); return 1; }
+            mutex mu;
+            Result r = run(n, per_thread, [&](int t, uint64_t i) {
+                char line[256];
+                int len = snprintf(line, sizeof(line), LOG_FMT, LOG_ARGS(t, i));
+                lock_guard<mutex> lk(mu);
+                if (write(fd, line, len) != len) { perror("write"); exit(1); }
+            }, [] {});
+            close(fd);
+            bool ok = verify_text(LOG_WRITE, n, per_thread);
+            rc |= !ok;
+            print_row("mutex+write", n, r, ok, "");
+        }
+        {
+            uint64_t stalls, writevs;
+            Result r;
+            {
+                AsyncLogger log(LOG_ASYNC);
+                r = run(n, per_thread, [&](int t, uint64_t i) { log.logf(LOG_FMT, LOG_ARGS(t, i)); },
+                        [&] { log.flush(); });
+                stalls = log.stalls();
+                writevs = log.writev_calls();
+            }
+            bool ok = verify_async(LOG_ASYNC, n, per_thread);
+            rc |= !ok;
+            print_row("async", n, r, ok,
+                      to_string(writevs) + " writev, " + to_string(stalls) + " ring-full stalls");
+        }
+    }
+    unlink(LOG_FPRINTF);
+    unlink(LOG_WRITE);
+    unlink(LOG_ASYNC);
+    return rc;
+}
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <iomanip>
 
+#include "../common/bench_results.h"
+
 int main(int argc, char* argv[]) {
     long iterations = 1'000'000; // default 1 million
     if (argc > 1)
@@ -29,6 +31,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Mutex benchmark:\n";
     std::cout << "Total time: " << std::fixed << std::setprecision(6) << mutex_sec << " s\n";
     std::cout << "Average per lock/unlock: " << std::setprecision(2) << mutex_ns << " ns\n\n";
+    bench::record("mutex_vs_atomic", "mutex lock/unlock", "threads=1", mutex_ns, "ns/op", bench::LOWER);
 
     // --- Atomic benchmark ---
     auto start_atomic = std::chrono::high_resolution_clock::now();
@@ -43,6 +46,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Atomic benchmark:\n";
     std::cout << "Total time: " << std::fixed << std::setprecision(6) << atomic_sec << " s\n";
     std::cout << "Average per atomic increment: " << std::setprecision(2) << atomic_ns << " ns\n";
+    bench::record("mutex_vs_atomic", "atomic fetch_add", "threads=1", atomic_ns, "ns/op", bench::LOWER);
 
     pthread_mutex_destroy(&mutex);
     return 0;
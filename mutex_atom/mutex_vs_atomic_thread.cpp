@@ -7,6 +7,8 @@
 #include <vector>
 #include <iomanip>
 
+#include "../common/bench_results.h"
+
 long iterations_per_thread = 1'000'000;
 int num_threads = 2;
 
@@ -50,6 +52,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Threads: " << num_threads << ", Iterations/thread: " << iterations_per_thread << "\n";
     std::cout << "Total time: " << std::fixed << std::setprecision(6) << mutex_sec << " s\n";
     std::cout << "Average per lock/unlock: " << std::setprecision(2) << (mutex_sec*1e9/total_mutex_ops) << " ns\n\n";
+    bench::record("mutex_vs_atomic_thread", "mutex lock/unlock", "threads=" + std::to_string(num_threads),
+                  mutex_sec * 1e9 / total_mutex_ops, "ns/op", bench::LOWER);
 
     // --- Atomic benchmark (seq_cst) ---
     atomic_counter.store(0, std::memory_order_seq_cst);
@@ -65,6 +69,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Threads: " << num_threads << ", Iterations/thread: " << iterations_per_thread << "\n";
     std::cout << "Total time: " << std::fixed << std::setprecision(6) << atomic_sec << " s\n";
     std::cout << "Average per atomic increment: " << std::setprecision(2) << (atomic_sec*1e9/total_mutex_ops) << " ns\n";
+    bench::record("mutex_vs_atomic_thread", "atomic fetch_add", "threads=" + std::to_string(num_threads),
+                  atomic_sec * 1e9 / total_mutex_ops, "ns/op", bench::LOWER);
 
     pthread_mutex_destroy(&mutex);
     return 0;
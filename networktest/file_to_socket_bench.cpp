@@ -0,0 +1,294 @@
+// file_to_socket_bench.cpp
+// Build: g++ -O2 -std=c++17 file_to_socket_bench.cpp -lpthread -o file_to_socket_bench
+// Run:   ./file_to_socket_bench [file_mb] [mode]
+//        mode: all (default), readwrite, sendfile, splice, vmsplice
+//        e.g. ./file_to_socket_bench 256 sendfile
+//
+// Streams a page-cached file to a loopback TCP server once per chunk size and
+// reports throughput plus the sender thread's user/sys CPU time.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/bench_results.h"
+
+constexpr const char* FILE_SOURCE = "test_file_to_socket.dat";
+constexpr size_t CHUNK_SIZES[] = {4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20};
+constexpr const char* MODES[] = {"readwrite", "sendfile", "splice", "vmsplice"};
+
+static std::atomic<uint64_t> g_received{0};
+
+static int make_server(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("socket"); std::exit(1); }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); std::exit(1); }
+    if (::listen(fd, 1) < 0) { perror("listen"); std::exit(1); }
+    return fd;
+}
+
+static void drain_fd(int cfd) {
+    std::vector<char> buf(1 << 20);
+    for (;;) {
+        ssize_t n = ::read(cfd, buf.data(), buf.size());
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            break;
+        }
+        g_received.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+    }
+}
+
+static void server_thread_fn(int lfd, int accepts) {
+    for (int i = 0; i < accepts; ++i) {
+        int cfd = ::accept(lfd, nullptr, nullptr);
+        if (cfd < 0) { perror("accept"); std::exit(1); }
+        drain_fd(cfd);
+        ::close(cfd);
+    }
+    ::close(lfd);
+}
+
+static int connect_client(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("socket"); std::exit(1); }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("connect"); std::exit(1); }
+    return fd;
+}
+
+static void write_all(int fd, const char* data, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = ::write(fd, data + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("write");
+            std::exit(1);
+        }
+        off += static_cast<size_t>(n);
+    }
+}
+
+// Move exactly len bytes from in_fd to out_fd where one side is a pipe.
+static void splice_all(int in_fd, int out_fd, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::splice(in_fd, nullptr, out_fd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("splice");
+            std::exit(1);
+        }
+        if (n == 0) { std::cerr << "splice: unexpected EOF\n"; std::exit(1); }
+        len -= static_cast<size_t>(n);
+    }
+}
+
+// ---------------- Send paths ----------------
+// Each returns after file_size bytes have been handed to the socket.
+
+static void send_readwrite(int sfd, int file_fd, size_t file_size, size_t chunk) {
+    std::vector<char> buf(chunk);
+    size_t off = 0;
+    while (off < file_size) {
+        ssize_t n = ::pread(file_fd, buf.data(), std::min(chunk, file_size - off), off);
+        if (n <= 0) { perror("pread"); std::exit(1); }
+        write_all(sfd, buf.data(), static_cast<size_t>(n));
+        off += static_cast<size_t>(n);
+    }
+}
+
+static void send_sendfile(int sfd, int file_fd, size_t file_size, size_t chunk) {
+    off_t off = 0;
+    while (static_cast<size_t>(off) < file_size) {
+        size_t want = std::min(chunk, file_size - static_cast<size_t>(off));
+        ssize_t n = ::sendfile(sfd, file_fd, &off, want);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("sendfile");
+            std::exit(1);
+        }
+        if (n == 0) { std::cerr << "sendfile: unexpected EOF\n"; std::exit(1); }
+    }
+}
+
+static void send_splice(int sfd, int file_fd, size_t file_size, size_t chunk) {
+    int p[2];
+    if (::pipe(p) < 0) { perror("pipe"); std::exit(1); }
+    // Let one chunk fit in the pipe; silently capped by /proc/sys/fs/pipe-max-size.
+    ::fcntl(p[1], F_SETPIPE_SZ, static_cast<int>(chunk));
+
+    loff_t off = 0;
+    while (static_cast<size_t>(off) < file_size) {
+        size_t want = std::min(chunk, file_size - static_cast<size_t>(off));
+        ssize_t n = ::splice(file_fd, &off, p[1], nullptr, want, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("splice (file->pipe)");
+            std::exit(1);
+        }
+        if (n == 0) { std::cerr << "splice: unexpected EOF\n"; std::exit(1); }
+        splice_all(p[0], sfd, static_cast<size_t>(n));
+    }
+    ::close(p[0]);
+    ::close(p[1]);
+}
+
+// The user buffer is loaded once and never modified afterwards, so the pages
+// referenced by the pipe stay valid without SPLICE_F_GIFT.
+static void send_vmsplice(int sfd, int file_fd, size_t file_size, size_t chunk) {
+    int p[2];
+    if (::pipe(p) < 0) { perror("pipe"); std::exit(1); }
+    ::fcntl(p[1], F_SETPIPE_SZ, static_cast<int>(chunk));
+
+    void* mem = nullptr;
+    if (posix_memalign(&mem, 4096, chunk) != 0) { std::cerr << "posix_memalign failed\n"; std::exit(1); }
+    char* buf = static_cast<char*>(mem);
+    if (::pread(file_fd, buf, chunk, 0) < 0) { perror("pread"); std::exit(1); }
+
+    size_t sent = 0;
+    while (sent < file_size) {
+        size_t want = std::min(chunk, file_size - sent);
+        iovec iov{buf, want};
+        while (iov.iov_len > 0) {
+            ssize_t n = ::vmsplice(p[1], &iov, 1, 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("vmsplice");
+                std::exit(1);
+            }
+            splice_all(p[0], sfd, static_cast<size_t>(n));
+            iov.iov_base = static_cast<char*>(iov.iov_base) + n;
+            iov.iov_len -= static_cast<size_t>(n);
+        }
+        sent += want;
+    }
+    free(buf);
+    ::close(p[0]);
+    ::close(p[1]);
+}
+
+// ---------------- Helpers ----------------
+
+static double tv_sec(const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + tv.tv_usec / 1e6;
+}
+
+static void create_source_file(size_t file_size) {
+    int fd = ::open(FILE_SOURCE, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) { perror("open (source)"); std::exit(1); }
+    std::vector<char> block(1 << 20, 'x');
+    for (size_t off = 0; off < file_size; off += block.size())
+        write_all(fd, block.data(), std::min(block.size(), file_size - off));
+    // Read back once so every mode starts from a warm page cache.
+    for (size_t off = 0; off < file_size; off += block.size())
+        if (::pread(fd, block.data(), block.size(), off) < 0) { perror("pread"); std::exit(1); }
+    ::close(fd);
+}
+
+int main(int argc, char** argv) {
+    const size_t file_mb = (argc > 1) ? static_cast<size_t>(std::stoull(argv[1])) : 256;
+    const std::string only = (argc > 2) ? argv[2] : "all";
+    const size_t file_size = file_mb << 20;
+    const uint16_t port = 55667;
+
+    std::vector<std::string> modes;
+    for (const char* m : MODES)
+        if (only == "all" || only == m) modes.push_back(m);
+    if (modes.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [file_mb] [all|readwrite|sendfile|splice|vmsplice]\n";
+        return 1;
+    }
+
+    std::cout << "[client] PID=" << getpid()
+              << " file=" << file_mb << " MB"
+              << " port=" << port << "\n";
+
+    create_source_file(file_size);
+    int file_fd = ::open(FILE_SOURCE, O_RDONLY);
+    if (file_fd < 0) { perror("open (source)"); return 1; }
+
+    const int runs = static_cast<int>(modes.size() * (sizeof(CHUNK_SIZES) / sizeof(CHUNK_SIZES[0])));
+    int lfd = make_server(port);
+    std::thread srv(server_thread_fn, lfd, runs);
+
+    std::cout << std::left << std::setw(10) << "Mode"
+              << std::right << std::setw(10) << "Chunk"
+              << std::setw(12) << "MB/s"
+              << std::setw(12) << "user ms"
+              << std::setw(12) << "sys ms" << "\n";
+
+    for (const auto& mode : modes) {
+        for (size_t chunk : CHUNK_SIZES) {
+            g_received.store(0);
+            int cfd = connect_client(port);
+
+            rusage ru0{}, ru1{};
+            ::getrusage(RUSAGE_THREAD, &ru0);
+            auto t0 = std::chrono::steady_clock::now();
+
+            if (mode == "readwrite")     send_readwrite(cfd, file_fd, file_size, chunk);
+            else if (mode == "sendfile") send_sendfile(cfd, file_fd, file_size, chunk);
+            else if (mode == "splice")   send_splice(cfd, file_fd, file_size, chunk);
+            else                         send_vmsplice(cfd, file_fd, file_size, chunk);
+
+            ::shutdown(cfd, SHUT_WR);
+            // Wait for the server to see EOF so the timing covers delivery.
+            char c;
+            while (::read(cfd, &c, 1) > 0) {}
+            auto t1 = std::chrono::steady_clock::now();
+            ::getrusage(RUSAGE_THREAD, &ru1);
+            ::close(cfd);
+
+            if (g_received.load() != file_size) {
+                std::cerr << "server received " << g_received.load() << " of " << file_size << " bytes\n";
+                return 1;
+            }
+
+            double sec = std::chrono::duration<double>(t1 - t0).count();
+            double user_ms = (tv_sec(ru1.ru_utime) - tv_sec(ru0.ru_utime)) * 1000.0;
+            double sys_ms  = (tv_sec(ru1.ru_stime) - tv_sec(ru0.ru_stime)) * 1000.0;
+            std::cout << std::left << std::setw(10) << mode
+                      << std::right << std::setw(9) << (chunk >> 10) << "K"
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << (file_size / (1024.0 * 1024.0)) / sec
+                      << std::setw(12) << user_ms
+                      << std::setw(12) << sys_ms << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            const std::string params = "chunk=" + std::to_string(chunk >> 10) + "K file=" + std::to_string(file_mb) + "M";
+            bench::record("file_to_socket", mode, params, (file_size / (1024.0 * 1024.0)) / sec, "MB/s", bench::HIGHER);
+            bench::record("file_to_socket", mode + " cpu", params, user_ms + sys_ms, "ms", bench::LOWER);
+        }
+    }
+
+    srv.join();
+    ::close(file_fd);
+    ::unlink(FILE_SOURCE);
+    return 0;
+}
@@ -1,20 +1,54 @@
 // tcp_flush_bench.cpp
 // Build: g++ -O2 -std=c++17 tcp_flush_bench.cpp -lpthread -o tcp_flush_bench
-// Run:   ./tcp_flush_bench [num_msgs] [payload_bytes] [batch_size]
+// Run:   ./tcp_flush_bench [num_msgs] [payload_bytes] [batch_size] [mode]
 //        e.g. ./tcp_flush_bench 1000000 32 1000
+//        mode: flush (default) - per-message vs batched writes
+//              zerocopy        - write_all copy vs MSG_ZEROCOPY over a payload sweep
+//                                (num_msgs/payload_bytes/batch_size are ignored)
+//              framed          - length-prefixed frames from a reused batch buffer, parsed
+//                                by the server; reports end-to-end parsed msgs/s
+//              server          - receive-side sweep over connection counts:
+//                                blocking thread-per-connection vs epoll vs
+//                                io_uring multishot accept/recv with a provided
+//                                buffer ring (other arguments are ignored)
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstring>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <string>
 #include <thread>
 #include <vector>
 
+#include "../common/bench_results.h"
+#include "../common/uring.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
 // helper: start strace attached to current process
 pid_t start_strace(const char* logfile) {
     pid_t pid = fork();
@@ -40,7 +74,7 @@ void stop_strace(pid_t spid) {
     waitpid(spid, nullptr, 0);
 }
 
-static int make_server(uint16_t port) {
+static int make_server(uint16_t port, int backlog = 1) {
     int fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0) { perror("socket"); std::exit(1); }
     int one = 1;
@@ -51,7 +85,7 @@ static int make_server(uint16_t port) {
     addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
     addr.sin_port = htons(port);
     if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); std::exit(1); }
-    if (::listen(fd, 1) < 0) { perror("listen"); std::exit(1); }
+    if (::listen(fd, backlog) < 0) { perror("listen"); std::exit(1); }
     return fd;
 }
 
@@ -68,17 +102,6 @@ static void drain_fd(int cfd) {
     }
 }
 
-static void server_thread_fn(uint16_t port, int accepts) {
-    int lfd = make_server(port);
-    for (int i = 0; i < accepts; ++i) {
-        int cfd = ::accept(lfd, nullptr, nullptr);
-        if (cfd < 0) { perror("accept"); std::exit(1); }
-        drain_fd(cfd);
-        ::close(cfd);
-    }
-    ::close(lfd);
-}
-
 static int connect_client(uint16_t port) {
     int fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0) { perror("socket"); std::exit(1); }
@@ -117,12 +140,756 @@ static void write_all(int fd, const char* data, size_t len) {
     }
 }
 
+// ---------------- Framing ----------------
+// Wire format: 4-byte little-endian payload length, then the payload.
+
+constexpr size_t FRAME_HDR = sizeof(uint32_t);
+constexpr char   FRAME_FILL = 'x';
+
+static std::atomic<uint64_t> g_frames_ok{0};
+static std::atomic<uint64_t> g_frames_bad{0};
+
+// Returns true when every byte of p[0, len) equals c. Stands in for the
+// per-byte validation a real decoder does on each frame body.
+static bool scan_payload(const char* p, size_t len, char c) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i want = _mm_set1_epi8(c);
+    __m128i diff = _mm_setzero_si128();
+    for (; i + 64 <= len; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 32));
+        __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 48));
+        diff = _mm_or_si128(diff, _mm_or_si128(_mm_xor_si128(a, want), _mm_xor_si128(b, want)));
+        diff = _mm_or_si128(diff, _mm_or_si128(_mm_xor_si128(d, want), _mm_xor_si128(e, want)));
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        diff = _mm_or_si128(diff, _mm_xor_si128(a, want));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) return false;
+#endif
+    for (; i < len; ++i)
+        if (p[i] != c) return false;
+    return true;
+}
+
+// Splits frames out of each read. Bytes of a frame that straddles two reads
+// are moved to the front of the buffer and completed by the next read; the
+// buffer grows only if a single frame is larger than it.
+static void drain_frames(int cfd) {
+    std::vector<char> buf(1 << 20);
+    size_t have = 0;
+    uint64_t ok = 0, bad = 0;
+    for (;;) {
+        if (have == buf.size()) buf.resize(buf.size() * 2);
+        ssize_t n = ::read(cfd, buf.data() + have, buf.size() - have);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            break;
+        }
+        have += static_cast<size_t>(n);
+
+        size_t pos = 0;
+        while (have - pos >= FRAME_HDR) {
+            uint32_t len;
+            std::memcpy(&len, buf.data() + pos, FRAME_HDR);
+            if (have - pos - FRAME_HDR < len) {
+                if (FRAME_HDR + len > buf.size()) buf.resize(FRAME_HDR + len);
+                break;
+            }
+            if (scan_payload(buf.data() + pos + FRAME_HDR, len, FRAME_FILL)) ++ok;
+            else ++bad;
+            pos += FRAME_HDR + len;
+        }
+        if (pos > 0) {
+            std::memmove(buf.data(), buf.data() + pos, have - pos);
+            have -= pos;
+        }
+    }
+    if (have != 0) ++bad;  // truncated trailing frame
+    g_frames_ok.fetch_add(ok);
+    g_frames_bad.fetch_add(bad);
+}
+
+// Serializes frames into one buffer, allocated up front with room for a whole
+// batch, and writes it out every batch_sz frames. write(2) has copied the
+// batch into the socket by the time it returns, so the buffer is reused at once.
+class FrameWriter {
+public:
+    FrameWriter(int fd, uint64_t batch_sz, size_t payload)
+        : fd_(fd), batch_sz_(batch_sz), buf_(batch_sz * (FRAME_HDR + payload)) {}
+
+    void append(const char* payload, uint32_t len) {
+        std::memcpy(buf_.data() + used_, &len, FRAME_HDR);
+        std::memcpy(buf_.data() + used_ + FRAME_HDR, payload, len);
+        used_ += FRAME_HDR + len;
+        if (++frames_ == batch_sz_) flush();
+    }
+
+    void flush() {
+        if (used_ == 0) return;
+        write_all(fd_, buf_.data(), used_);
+        used_ = 0;
+        frames_ = 0;
+    }
+
+    ~FrameWriter() { flush(); }
+
+private:
+    int fd_;
+    uint64_t batch_sz_;
+    std::vector<char> buf_;
+    size_t used_ = 0;
+    uint64_t frames_ = 0;
+};
+
+static void server_thread_fn(uint16_t port, int accepts, bool framed) {
+    int lfd = make_server(port);
+    for (int i = 0; i < accepts; ++i) {
+        int cfd = ::accept(lfd, nullptr, nullptr);
+        if (cfd < 0) { perror("accept"); std::exit(1); }
+        if (framed) drain_frames(cfd);
+        else drain_fd(cfd);
+        ::close(cfd);
+    }
+    ::close(lfd);
+}
+
+// ---------------- MSG_ZEROCOPY ----------------
+// A send with MSG_ZEROCOPY pins the user pages instead of copying them; the
+// kernel reports when it is done with them through the socket error queue as
+// a range [lo, hi] of per-socket send ids. A buffer may only be rewritten once
+// every send that referenced it has completed.
+
+constexpr size_t ZC_TOTAL_BYTES = 512ULL << 20;  // bytes sent per payload size
+constexpr size_t ZC_BUFFERS     = 16;            // buffers recycled round-robin
+constexpr size_t ZC_PAYLOADS[]  = {1 << 10, 4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20};
+
+class ZeroCopySender {
+public:
+    ZeroCopySender(int fd, size_t payload)
+        : fd_(fd), bufs_(ZC_BUFFERS, std::vector<char>(payload, 'x')), inflight_(ZC_BUFFERS, 0) {
+        int one = 1;
+        if (::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) < 0) {
+            perror("setsockopt SO_ZEROCOPY");
+            std::exit(1);
+        }
+    }
+
+    // Returns buffer i once the kernel no longer references it.
+    char* acquire(size_t i) {
+        size_t b = i % bufs_.size();
+        while (inflight_[b] > 0) reap(true);
+        return bufs_[b].data();
+    }
+
+    void send_all(size_t i, size_t len) {
+        size_t b = i % bufs_.size();
+        const char* data = bufs_[b].data();
+        size_t off = 0;
+        while (off < len) {
+            ssize_t n = ::send(fd_, data + off, len - off, MSG_ZEROCOPY);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == ENOBUFS) { reap(true); continue; }  // optmem_max exhausted
+                perror("send MSG_ZEROCOPY");
+                std::exit(1);
+            }
+            pending_.push_back({next_id_++, b, false});
+            ++inflight_[b];
+            off += static_cast<size_t>(n);
+        }
+        reap(false);
+    }
+
+    void wait_all() {
+        while (!pending_.empty()) reap(true);
+    }
+
+    uint64_t completed() const { return completed_; }
+    uint64_t copied() const { return copied_; }
+
+private:
+    struct Pending { uint32_t id; size_t buf; bool done; };
+
+    // Drain the error queue; with block set, sleep until at least one
+    // notification is available.
+    void reap(bool block) {
+        for (;;) {
+            char control[128];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(fd_, &msg, MSG_ERRQUEUE) < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN) { perror("recvmsg MSG_ERRQUEUE"); std::exit(1); }
+                if (!block) return;
+                pollfd pfd{fd_, 0, 0};  // POLLERR is always reported
+                if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) { perror("poll"); std::exit(1); }
+                continue;
+            }
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                bool is_recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+                if (!is_recverr) continue;
+                auto* serr = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cm));
+                if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+                complete(serr->ee_info, serr->ee_data, serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+            }
+            return;
+        }
+    }
+
+    void complete(uint32_t lo, uint32_t hi, bool copied) {
+        uint64_t n = static_cast<uint64_t>(hi - lo) + 1;
+        completed_ += n;
+        if (copied) copied_ += n;
+        if (pending_.empty()) return;
+        uint32_t base = pending_.front().id;
+        for (uint32_t id = lo; id != hi + 1; ++id) {
+            uint32_t idx = id - base;
+            if (idx < pending_.size()) pending_[idx].done = true;
+        }
+        while (!pending_.empty() && pending_.front().done) {
+            --inflight_[pending_.front().buf];
+            pending_.pop_front();
+        }
+    }
+
+    int fd_;
+    std::vector<std::vector<char>> bufs_;
+    std::vector<uint32_t> inflight_;
+    std::deque<Pending> pending_;
+    uint32_t next_id_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t copied_ = 0;
+};
+
+static double cpu_sec(const rusage& ru) {
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+// Half-close and wait for the server to hit EOF so timings include delivery.
+static void finish_client(int fd) {
+    ::shutdown(fd, SHUT_WR);
+    char c;
+    while (::read(fd, &c, 1) > 0) {}
+    ::close(fd);
+}
+
+// Same two phases as flush mode, but every message is a length-prefixed frame
+// and the server parses and validates each one. Time runs until the server
+// has consumed the connection, so msgs/s counts parsed messages.
+static int run_framed(uint64_t num_msgs, size_t payload, uint64_t batch_sz, uint16_t port) {
+    std::thread srv(server_thread_fn, port, 2, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // reduce connect race
+
+    std::vector<char> msg(payload, FRAME_FILL);
+    const uint64_t batches[2] = {1, batch_sz};
+    double ms[2];
+    uint64_t parsed[2];
+
+    for (int phase = 0; phase < 2; ++phase) {
+        int cfd = connect_client(port);
+        uint64_t before = g_frames_ok.load();
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            FrameWriter w(cfd, batches[phase], payload);
+            for (uint64_t i = 0; i < num_msgs; ++i)
+                w.append(msg.data(), static_cast<uint32_t>(payload));
+        }
+        finish_client(cfd);
+        auto t1 = std::chrono::steady_clock::now();
+        ms[phase] = std::chrono::duration<double>(t1 - t0).count() * 1000.0;
+        parsed[phase] = g_frames_ok.load() - before;
+    }
+    srv.join();
+
+    std::cout << "Messages: " << num_msgs
+              << ", payload: " << payload << " bytes"
+              << ", batch_sz: " << batch_sz
+              << ", bad frames: " << g_frames_bad.load() << "\n";
+    std::cout << "Per-message frames: " << ms[0] << " ms total, "
+              << (parsed[0] * 1000.0 / ms[0]) << " parsed msgs/s\n";
+    std::cout << "Batched frames    : " << ms[1] << " ms total, "
+              << (parsed[1] * 1000.0 / ms[1]) << " parsed msgs/s\n";
+    const std::string params = "msgs=" + std::to_string(num_msgs) + " payload=" + std::to_string(payload) +
+                               " batch=" + std::to_string(batch_sz);
+    bench::record("tcp_framed", "per-message", params, parsed[0] * 1000.0 / ms[0], "msgs/s", bench::HIGHER);
+    bench::record("tcp_framed", "batched", params, parsed[1] * 1000.0 / ms[1], "msgs/s", bench::HIGHER);
+    return (g_frames_bad.load() == 0 && parsed[0] == num_msgs && parsed[1] == num_msgs) ? 0 : 1;
+}
+
+static int run_zerocopy_sweep(uint16_t port) {
+    const size_t npayloads = sizeof(ZC_PAYLOADS) / sizeof(ZC_PAYLOADS[0]);
+    std::thread srv(server_thread_fn, port, static_cast<int>(2 * npayloads), false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // reduce connect race
+
+    std::cout << std::setw(10) << "Payload"
+              << std::setw(14) << "copy MB/s"
+              << std::setw(14) << "copy cpu ms"
+              << std::setw(14) << "zc MB/s"
+              << std::setw(14) << "zc cpu ms"
+              << std::setw(12) << "zc copied" << "\n";
+
+    for (size_t payload : ZC_PAYLOADS) {
+        const size_t sends = ZC_TOTAL_BYTES / payload;
+        double sec[2], cpu[2];
+        uint64_t copied = 0, completed = 0;
+
+        for (int zc = 0; zc < 2; ++zc) {
+            int cfd = connect_client(port);
+            rusage ru0{}, ru1{};
+            ::getrusage(RUSAGE_THREAD, &ru0);
+            auto t0 = std::chrono::steady_clock::now();
+
+            if (zc) {
+                ZeroCopySender sender(cfd, payload);
+                for (size_t i = 0; i < sends; ++i) {
+                    char* buf = sender.acquire(i);
+                    std::memcpy(buf, &i, sizeof(i));  // stamp: a real producer rewrites the buffer
+                    sender.send_all(i, payload);
+                }
+                sender.wait_all();
+                copied = sender.copied();
+                completed = sender.completed();
+            } else {
+                std::vector<std::vector<char>> bufs(ZC_BUFFERS, std::vector<char>(payload, 'x'));
+                for (size_t i = 0; i < sends; ++i) {
+                    char* buf = bufs[i % bufs.size()].data();
+                    std::memcpy(buf, &i, sizeof(i));
+                    write_all(cfd, buf, payload);
+                }
+            }
+
+            finish_client(cfd);
+            auto t1 = std::chrono::steady_clock::now();
+            ::getrusage(RUSAGE_THREAD, &ru1);
+            sec[zc] = std::chrono::duration<double>(t1 - t0).count();
+            cpu[zc] = cpu_sec(ru1) - cpu_sec(ru0);
+        }
+
+        const double mb = ZC_TOTAL_BYTES / (1024.0 * 1024.0);
+        std::cout << std::setw(9) << (payload >> 10) << "K"
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << mb / sec[0]
+                  << std::setw(14) << cpu[0] * 1000.0
+                  << std::setw(14) << mb / sec[1]
+                  << std::setw(14) << cpu[1] * 1000.0
+                  << std::setw(7) << copied << "/" << completed << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        const std::string params = "payload=" + std::to_string(payload >> 10) + "K";
+        bench::record("tcp_zerocopy", "copy", params, mb / sec[0], "MB/s", bench::HIGHER);
+        bench::record("tcp_zerocopy", "MSG_ZEROCOPY", params, mb / sec[1], "MB/s", bench::HIGHER);
+    }
+
+    srv.join();
+    // On loopback the receiver forces a deferred copy, so every completion is
+    // flagged SO_EE_CODE_ZEROCOPY_COPIED; the pinning/notification overhead is
+    // still measured, but the memcpy saving only materializes on a real NIC.
+    return 0;
+}
+
+// ---------------- Receive-side server designs ----------------
+// N clients each stream SRV_TOTAL_BYTES / N to one server, which uses either a
+// blocking reader thread per connection, one epoll thread (level-triggered,
+// one read per readiness event), or one io_uring thread with multishot accept
+// and multishot recv drawing from a provided buffer ring. Every server reads
+// into SRV_BUF-sized buffers; syscalls are counted in the server code itself.
+
+constexpr size_t   SRV_TOTAL_BYTES = 256ULL << 20;
+constexpr size_t   SRV_CHUNK       = 16 << 10;   // client write size
+constexpr size_t   SRV_BUF         = 64 << 10;   // server read / provided buffer size
+constexpr unsigned SRV_RING_BUFS   = 256;        // provided buffers, power of two
+constexpr uint16_t SRV_BGID        = 1;
+constexpr int      SRV_CONNS[]     = {1, 4, 16, 64};
+constexpr uint64_t SRV_ACCEPT_TAG  = 1ULL << 32;  // user_data of the accept SQE
+constexpr uint64_t SRV_PROVIDE_TAG = 2ULL << 32;  // user_data of PROVIDE_BUFFERS SQEs
+
+struct ServerStats {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> cpu_us{0};
+
+    // Adds the calling thread's CPU time since it started.
+    void add_thread_cpu() {
+        rusage ru{};
+        ::getrusage(RUSAGE_THREAD, &ru);
+        cpu_us += static_cast<uint64_t>(cpu_sec(ru) * 1e6);
+    }
+};
+
+static void serve_blocking(int lfd, int conns, ServerStats& st) {
+    std::vector<std::thread> readers;
+    for (int i = 0; i < conns; ++i) {
+        int cfd = ::accept(lfd, nullptr, nullptr);
+        st.syscalls++;
+        if (cfd < 0) { perror("accept"); std::exit(1); }
+        readers.emplace_back([cfd, &st] {
+            std::vector<char> buf(SRV_BUF);
+            uint64_t bytes = 0, calls = 0;
+            for (;;) {
+                ssize_t n = ::read(cfd, buf.data(), buf.size());
+                ++calls;
+                if (n == 0) break;
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    perror("read");
+                    break;
+                }
+                bytes += static_cast<uint64_t>(n);
+            }
+            ::close(cfd);
+            st.bytes += bytes;
+            st.syscalls += calls + 1;
+            st.add_thread_cpu();
+        });
+    }
+    for (auto& t : readers) t.join();
+    st.add_thread_cpu();
+}
+
+static void serve_epoll(int lfd, int conns, ServerStats& st) {
+    int ep = ::epoll_create1(0);
+    if (ep < 0) { perror("epoll_create1"); std::exit(1); }
+    ::fcntl(lfd, F_SETFL, ::fcntl(lfd, F_GETFL) | O_NONBLOCK);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = lfd;
+    ::epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+
+    std::vector<char> buf(SRV_BUF);
+    std::vector<epoll_event> events(256);
+    uint64_t bytes = 0, calls = 0;
+    int closed = 0;
+    while (closed < conns) {
+        int n = ::epoll_wait(ep, events.data(), static_cast<int>(events.size()), -1);
+        ++calls;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            std::exit(1);
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == lfd) {
+                for (;;) {
+                    int cfd = ::accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK);
+                    ++calls;
+                    if (cfd < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                        perror("accept4");
+                        std::exit(1);
+                    }
+                    epoll_event cev{};
+                    cev.events = EPOLLIN;
+                    cev.data.fd = cfd;
+                    ::epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &cev);
+                    ++calls;
+                }
+                continue;
+            }
+            ssize_t r = ::read(fd, buf.data(), buf.size());
+            ++calls;
+            if (r > 0) {
+                bytes += static_cast<uint64_t>(r);
+            } else if (r == 0 || (errno != EAGAIN && errno != EINTR)) {
+                if (r < 0) perror("read");
+                ::close(fd);  // also drops it from the epoll set
+                ++calls;
+                ++closed;
+            }
+        }
+    }
+    ::close(ep);
+    st.bytes += bytes;
+    st.syscalls += calls;
+    st.add_thread_cpu();
+}
+
+// Buffers shared by every multishot recv through one buffer group. Preferred
+// is a provided buffer ring (IORING_REGISTER_PBUF_RING): returning a buffer
+// is a store into shared memory. Kernels whose ring selection fails fall
+// back to IORING_OP_PROVIDE_BUFFERS, where each returned buffer is one SQE
+// riding along with the next io_uring_enter (CQE skipped on success).
+class ProvidedBuffers {
+public:
+    ProvidedBuffers(Uring& ring, bool use_ring)
+        : ring_(ring), use_ring_(use_ring), pool_(static_cast<size_t>(SRV_RING_BUFS) * SRV_BUF) {
+        if (!use_ring_) {
+            io_uring_sqe* sqe = next_sqe();
+            prep_provide(sqe, 0, SRV_RING_BUFS);
+            int r = ring_.submit_and_wait(1);
+            int res = r;
+            ring_.for_each_cqe([&](const io_uring_cqe& cqe) { res = cqe.res; });
+            ok_ = r >= 0 && res >= 0;
+            return;
+        }
+        ring_bytes_ = SRV_RING_BUFS * sizeof(io_uring_buf);
+        void* p = ::mmap(nullptr, ring_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) { perror("mmap"); std::exit(1); }
+        br_ = static_cast<io_uring_buf_ring*>(p);
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(br_);
+        reg.ring_entries = SRV_RING_BUFS;
+        reg.bgid = SRV_BGID;
+        ok_ = ring_.reg(IORING_REGISTER_PBUF_RING, &reg, 1) == 0;
+        for (unsigned bid = 0; bid < SRV_RING_BUFS; ++bid) give_back(bid);
+        publish();
+    }
+    ~ProvidedBuffers() {
+        if (br_) ::munmap(br_, ring_bytes_);
+    }
+
+    bool ok() const { return ok_; }
+    const char* mechanism() const { return use_ring_ ? "buffer ring" : "PROVIDE_BUFFERS"; }
+
+    // Queues buffer `bid` for reuse; the kernel sees it after publish() (ring)
+    // or the next submit (legacy). Ring entries get only addr/len/bid written:
+    // bufs[0]'s reserved field is the ring tail.
+    void give_back(unsigned bid) {
+        if (!use_ring_) {
+            prep_provide(next_sqe(), bid, 1);
+            return;
+        }
+        io_uring_buf& b = br_->bufs[tail_ & (SRV_RING_BUFS - 1)];
+        b.addr = reinterpret_cast<uint64_t>(pool_.data() + static_cast<size_t>(bid) * SRV_BUF);
+        b.len = static_cast<uint32_t>(SRV_BUF);
+        b.bid = static_cast<uint16_t>(bid);
+        ++tail_;
+    }
+
+    void publish() {
+        if (use_ring_) __atomic_store_n(&br_->tail, tail_, __ATOMIC_RELEASE);
+    }
+
+private:
+    io_uring_sqe* next_sqe() {
+        io_uring_sqe* sqe;
+        while (!(sqe = ring_.get_sqe())) ring_.submit_and_wait(0);
+        return sqe;
+    }
+
+    void prep_provide(io_uring_sqe* sqe, unsigned bid, unsigned count) {
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(count);
+        sqe->addr = reinterpret_cast<uint64_t>(pool_.data() + static_cast<size_t>(bid) * SRV_BUF);
+        sqe->len = static_cast<uint32_t>(SRV_BUF);
+        sqe->off = bid;
+        sqe->buf_group = SRV_BGID;
+        sqe->user_data = SRV_PROVIDE_TAG;
+        if (count == 1) sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    }
+
+    Uring& ring_;
+    bool use_ring_;
+    bool ok_ = false;
+    std::vector<char> pool_;
+    io_uring_buf_ring* br_ = nullptr;
+    size_t ring_bytes_ = 0;
+    uint16_t tail_ = 0;
+};
+
+// Receives one message on a socketpair through the buffer group; the ring
+// variant registers fine but selects nothing on some kernels.
+static bool provided_buffers_work(bool use_ring) {
+    Uring ring(8);
+    if (!ring.valid()) return false;
+    ProvidedBuffers bufs(ring, use_ring);
+    if (!bufs.ok()) return false;
+    int sv[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    write_all(sv[1], "x", 1);
+    io_uring_sqe* sqe = ring.get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = sv[0];
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = SRV_BGID;
+    int res = -1;
+    if (ring.submit_and_wait(1) >= 0)
+        ring.for_each_cqe([&](const io_uring_cqe& cqe) { res = cqe.res; });
+    ::close(sv[0]);
+    ::close(sv[1]);
+    return res == 1;
+}
+
+// Provided-buffer mechanism the io_uring server uses: 1 = ring, 0 = legacy,
+// -1 = io_uring multishot recv unusable.
+static int g_pbuf_mode = -1;
+
+static void serve_uring(int lfd, int conns, ServerStats& st) {
+    Uring ring(256);
+    if (!ring.valid()) { std::cerr << "io_uring_setup failed\n"; std::exit(1); }
+    ProvidedBuffers bufs(ring, g_pbuf_mode == 1);
+    if (!bufs.ok()) { std::cerr << "io_uring provided buffers setup failed\n"; std::exit(1); }
+
+    auto next_sqe = [&] {
+        io_uring_sqe* sqe;
+        while (!(sqe = ring.get_sqe())) ring.submit_and_wait(0);
+        return sqe;
+    };
+    auto arm_accept = [&] {
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = lfd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->user_data = SRV_ACCEPT_TAG;
+    };
+    auto arm_recv = [&](int fd) {
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = SRV_BGID;
+        sqe->user_data = static_cast<uint64_t>(fd);
+    };
+
+    arm_accept();
+    uint64_t bytes = 0, closes = 0;
+    int accepted = 0, closed = 0;
+    while (closed < conns) {
+        int r = ring.submit_and_wait(1);
+        if (r < 0) { errno = -r; perror("io_uring_enter"); std::exit(1); }
+        ring.for_each_cqe([&](const io_uring_cqe& cqe) {
+            bool more = cqe.flags & IORING_CQE_F_MORE;
+            if (cqe.user_data == SRV_PROVIDE_TAG) {
+                if (cqe.res < 0) { errno = -cqe.res; perror("provide buffers"); std::exit(1); }
+                return;
+            }
+            if (cqe.user_data == SRV_ACCEPT_TAG) {
+                if (cqe.res < 0) { errno = -cqe.res; perror("accept"); std::exit(1); }
+                arm_recv(cqe.res);
+                if (++accepted < conns && !more) arm_accept();
+                return;
+            }
+            int fd = static_cast<int>(cqe.user_data);
+            if (cqe.flags & IORING_CQE_F_BUFFER) bufs.give_back(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0) {
+                bytes += static_cast<uint64_t>(cqe.res);
+                if (!more) arm_recv(fd);
+            } else if (cqe.res == -ENOBUFS) {
+                arm_recv(fd);  // buffers are handed back below, before the next submit
+            } else {
+                if (cqe.res < 0) { errno = -cqe.res; perror("recv"); }
+                ::close(fd);
+                ++closes;
+                ++closed;
+            }
+        });
+        bufs.publish();
+    }
+    st.bytes += bytes;
+    st.syscalls += ring.enter_calls() + closes;
+    st.add_thread_cpu();
+}
+
+struct ServerDesign {
+    const char* name;
+    void (*serve)(int lfd, int conns, ServerStats& st);
+};
+
+static int run_server_sweep(uint16_t port) {
+    std::vector<ServerDesign> designs = {{"blocking", serve_blocking}, {"epoll", serve_epoll}};
+    if (provided_buffers_work(true)) g_pbuf_mode = 1;
+    else if (provided_buffers_work(false)) g_pbuf_mode = 0;
+    if (g_pbuf_mode >= 0) {
+        designs.push_back({"io_uring", serve_uring});
+        std::cout << "io_uring recv buffers: "
+                  << (g_pbuf_mode ? "provided buffer ring" : "IORING_OP_PROVIDE_BUFFERS (buffer ring selection failed)")
+                  << "\n";
+    } else {
+        std::cout << "io_uring multishot recv with provided buffers unavailable, skipping\n";
+    }
+
+    std::cout << std::left << std::setw(10) << "Server" << std::right
+              << std::setw(7) << "Conns"
+              << std::setw(10) << "MB/s"
+              << std::setw(12) << "syscalls"
+              << std::setw(14) << "syscalls/MB"
+              << std::setw(14) << "cpu us/MB" << "\n";
+
+    const double mb = SRV_TOTAL_BYTES / (1024.0 * 1024.0);
+    for (int conns : SRV_CONNS) {
+        const size_t share = SRV_TOTAL_BYTES / conns / SRV_CHUNK * SRV_CHUNK;
+        for (const ServerDesign& d : designs) {
+            int lfd = make_server(port, SOMAXCONN);
+            ServerStats st;
+            auto t0 = std::chrono::steady_clock::now();
+            std::thread srv([&] { d.serve(lfd, conns, st); });
+            std::vector<std::thread> clients;
+            for (int c = 0; c < conns; ++c) {
+                clients.emplace_back([&] {
+                    std::vector<char> chunk(SRV_CHUNK, 'x');
+                    int cfd = connect_client(port);
+                    for (size_t sent = 0; sent < share; sent += SRV_CHUNK)
+                        write_all(cfd, chunk.data(), chunk.size());
+                    ::close(cfd);
+                });
+            }
+            for (auto& c : clients) c.join();
+            srv.join();
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            ::close(lfd);
+
+            if (st.bytes.load() != share * conns) {
+                std::cerr << d.name << ": received " << st.bytes.load() << " of " << share * conns << " bytes\n";
+                return 1;
+            }
+            std::cout << std::left << std::setw(10) << d.name << std::right
+                      << std::setw(7) << conns
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(10) << mb / sec
+                      << std::setw(12) << st.syscalls.load()
+                      << std::setw(14) << st.syscalls.load() / mb
+                      << std::setw(14) << st.cpu_us.load() / mb << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            const std::string params = "conns=" + std::to_string(conns);
+            bench::record("tcp_server", d.name, params, mb / sec, "MB/s", bench::HIGHER);
+            bench::record("tcp_server", std::string(d.name) + " cpu", params, st.cpu_us.load() / mb, "us/MB", bench::LOWER);
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char** argv) {
     const uint64_t num_msgs = (argc > 1) ? std::stoull(argv[1]) : 1000000ULL;
     const size_t   payload  = (argc > 2) ? static_cast<size_t>(std::stoull(argv[2])) : 100;
     const uint64_t batch_sz = (argc > 3) ? std::stoull(argv[3]) : 1000ULL;
+    const std::string mode  = (argc > 4) ? argv[4] : "flush";
     const uint16_t port = 55666;
 
+    if (mode == "zerocopy") {
+        std::cout << "[client] PID=" << getpid()
+                  << " mode=zerocopy total=" << (ZC_TOTAL_BYTES >> 20) << " MB/payload"
+                  << " port=" << port << "\n";
+        return run_zerocopy_sweep(port);
+    }
+    if (mode == "framed") {
+        std::cout << "[client] PID=" << getpid()
+                  << " mode=framed num_msgs=" << num_msgs
+                  << " payload=" << payload
+                  << " batch_sz=" << batch_sz
+                  << " port=" << port << "\n";
+        return run_framed(num_msgs, payload, batch_sz, port);
+    }
+    if (mode == "server") {
+        std::cout << "[client] PID=" << getpid()
+                  << " mode=server total=" << (SRV_TOTAL_BYTES >> 20) << " MB/run"
+                  << " port=" << port << "\n";
+        return run_server_sweep(port);
+    }
+    if (mode != "flush") {
+        std::cerr << "unknown mode: " << mode << " (expected flush|zerocopy|framed|server)\n";
+        return 1;
+    }
+
     std::cout << "[client] PID=" << getpid()
               << " num_msgs=" << num_msgs
               << " payload=" << payload
@@ -130,7 +897,7 @@ int main(int argc, char** argv) {
               << " port=" << port << "\n";
 
     // Server will accept 2 connections (per-message phase, then batched phase)
-    std::thread srv(server_thread_fn, port, 2);
+    std::thread srv(server_thread_fn, port, 2, false);
     std::this_thread::sleep_for(std::chrono::milliseconds(50)); // reduce connect race
 
     int cfd = connect_client(port);
@@ -187,5 +954,9 @@ int main(int argc, char** argv) {
               << (per_ms * 1000.0 / num_msgs) << " us/msg\n";
     std::cout << "Batched writes    : " << bat_ms << " ms total, "
               << (bat_ms * 1000.0 / num_msgs) << " us/msg\n";
+    const std::string params = "msgs=" + std::to_string(num_msgs) + " payload=" + std::to_string(payload) +
+                               " batch=" + std::to_string(batch_sz);
+    bench::record("tcp_flush", "per-message", params, per_ms * 1000.0 / num_msgs, "us/msg", bench::LOWER);
+    bench::record("tcp_flush", "batched", params, bat_ms * 1000.0 / num_msgs, "us/msg", bench::LOWER);
     return 0;
 }
@@ -0,0 +1,285 @@
+// udp_batch_bench.cpp
+// Build: g++ -O2 -std=c++17 udp_batch_bench.cpp -lpthread -o udp_batch_bench
+// Run:   ./udp_batch_bench [num_msgs] [payload_bytes]
+//        e.g. ./udp_batch_bench 1000000 100
+//
+// Loopback UDP counterpart of tcp_flush_bench: one sendto per message vs
+// sendmmsg batches vs UDP_SEGMENT (GSO) super-packets, received with
+// recvmmsg + UDP_GRO. Reports msgs/s, drop rate and CPU per message.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/bench_results.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+constexpr uint64_t BATCH_SIZES[] = {1, 10, 100, 1000};
+constexpr size_t   GSO_MAX_SEGS  = 64;      // UDP_MAX_SEGMENTS on older kernels
+constexpr size_t   UDP_MAX_LEN   = 65507;   // max IPv4 UDP payload
+constexpr size_t   RECV_BATCH    = 64;
+constexpr size_t   RECV_BUF_LEN  = 65536;   // room for a GRO-coalesced datagram
+constexpr int      SOCK_BUF      = 16 << 20;
+
+static double cpu_sec() {
+    rusage ru{};
+    ::getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static sockaddr_in loopback_addr(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+static void set_buf(int fd, int opt_force, int opt, int size) {
+    // The *FORCE variants bypass rmem_max/wmem_max but need CAP_NET_ADMIN.
+    if (::setsockopt(fd, SOL_SOCKET, opt_force, &size, sizeof(size)) < 0)
+        ::setsockopt(fd, SOL_SOCKET, opt, &size, sizeof(size));
+}
+
+// ---------------- Receiver ----------------
+
+struct RecvStats {
+    uint64_t msgs = 0;
+    uint64_t datagrams = 0;  // after GRO coalescing
+    double cpu = 0;
+};
+
+static int make_receiver(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) { perror("socket"); std::exit(1); }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    set_buf(fd, SO_RCVBUFFORCE, SO_RCVBUF, SOCK_BUF);
+    if (::setsockopt(fd, IPPROTO_UDP, UDP_GRO, &one, sizeof(one)) < 0)
+        perror("setsockopt UDP_GRO (continuing without)");
+
+    sockaddr_in addr = loopback_addr(port);
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); std::exit(1); }
+    return fd;
+}
+
+// Receive until the sender is done and the socket has been idle for 100 ms.
+static void receiver_fn(int fd, const std::atomic<bool>* sender_done, RecvStats* out) {
+    std::vector<char> bufs(RECV_BATCH * RECV_BUF_LEN);
+    std::vector<iovec> iov(RECV_BATCH);
+    std::vector<mmsghdr> msgs(RECV_BATCH);
+    std::vector<char> ctrl(RECV_BATCH * CMSG_SPACE(sizeof(int)));
+
+    double cpu0 = cpu_sec();
+    RecvStats st;
+    for (;;) {
+        for (size_t i = 0; i < RECV_BATCH; ++i) {
+            iov[i] = {bufs.data() + i * RECV_BUF_LEN, RECV_BUF_LEN};
+            msgs[i].msg_hdr = msghdr{};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = ctrl.data() + i * CMSG_SPACE(sizeof(int));
+            msgs[i].msg_hdr.msg_controllen = CMSG_SPACE(sizeof(int));
+        }
+        int n = ::recvmmsg(fd, msgs.data(), RECV_BATCH, MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) { perror("recvmmsg"); std::exit(1); }
+            pollfd pfd{fd, POLLIN, 0};
+            int r = ::poll(&pfd, 1, 100);
+            if (r == 0 && sender_done->load()) break;
+            continue;
+        }
+        for (int i = 0; i < n; ++i) {
+            size_t len = msgs[i].msg_len;
+            size_t seg = 0;
+            msghdr& mh = msgs[i].msg_hdr;
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&mh); cm; cm = CMSG_NXTHDR(&mh, cm)) {
+                if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                    int gso_size;
+                    std::memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+                    seg = static_cast<size_t>(gso_size);
+                }
+            }
+            st.msgs += (seg > 0) ? (len + seg - 1) / seg : 1;
+            st.datagrams += 1;
+        }
+    }
+    st.cpu = cpu_sec() - cpu0;
+    *out = st;
+}
+
+// ---------------- Senders ----------------
+
+static void send_per_message(int fd, const sockaddr_in& dst, const char* msg, size_t payload,
+                             uint64_t num_msgs, uint64_t) {
+    for (uint64_t i = 0; i < num_msgs; ++i) {
+        while (::sendto(fd, msg, payload, 0, (const sockaddr*)&dst, sizeof(dst)) < 0) {
+            if (errno == EINTR || errno == ENOBUFS) continue;
+            perror("sendto");
+            std::exit(1);
+        }
+    }
+}
+
+static void send_mmsg(int fd, const sockaddr_in& dst, const char* msg, size_t payload,
+                      uint64_t num_msgs, uint64_t batch_sz) {
+    iovec iov{const_cast<char*>(msg), payload};
+    std::vector<mmsghdr> hdrs(batch_sz);
+    for (auto& h : hdrs) {
+        h.msg_hdr = msghdr{};
+        h.msg_hdr.msg_name = const_cast<sockaddr_in*>(&dst);
+        h.msg_hdr.msg_namelen = sizeof(dst);
+        h.msg_hdr.msg_iov = &iov;
+        h.msg_hdr.msg_iovlen = 1;
+    }
+
+    uint64_t sent = 0;
+    while (sent < num_msgs) {
+        unsigned want = static_cast<unsigned>(std::min<uint64_t>(batch_sz, num_msgs - sent));
+        int n = ::sendmmsg(fd, hdrs.data(), want, 0);
+        if (n < 0) {
+            if (errno == EINTR || errno == ENOBUFS) continue;
+            perror("sendmmsg");
+            std::exit(1);
+        }
+        sent += static_cast<uint64_t>(n);
+    }
+}
+
+// Each batch goes out as ceil(batch / segs) sendmsg calls, each carrying one
+// super-packet that the stack splits into payload-sized datagrams.
+static void send_gso(int fd, const sockaddr_in& dst, const char* msg, size_t payload,
+                     uint64_t num_msgs, uint64_t batch_sz) {
+    const size_t max_segs = std::min<size_t>(GSO_MAX_SEGS, UDP_MAX_LEN / payload);
+    std::vector<char> super(max_segs * payload);
+    for (size_t i = 0; i < max_segs; ++i)
+        std::memcpy(super.data() + i * payload, msg, payload);
+
+    char ctrl[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr mh{};
+    iovec iov{super.data(), 0};
+    mh.msg_name = const_cast<sockaddr_in*>(&dst);
+    mh.msg_namelen = sizeof(dst);
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = ctrl;
+    mh.msg_controllen = sizeof(ctrl);
+    cmsghdr* cm = CMSG_FIRSTHDR(&mh);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gso_size = static_cast<uint16_t>(payload);
+    std::memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+    uint64_t sent = 0;
+    while (sent < num_msgs) {
+        uint64_t this_batch = std::min<uint64_t>(batch_sz, num_msgs - sent);
+        while (this_batch > 0) {
+            size_t segs = std::min<uint64_t>(this_batch, max_segs);
+            iov.iov_len = segs * payload;
+            if (::sendmsg(fd, &mh, 0) < 0) {
+                if (errno == EINTR || errno == ENOBUFS) continue;
+                perror("sendmsg UDP_SEGMENT");
+                std::exit(1);
+            }
+            this_batch -= segs;
+            sent += segs;
+        }
+    }
+}
+
+using SendFn = void (*)(int, const sockaddr_in&, const char*, size_t, uint64_t, uint64_t);
+
+int main(int argc, char** argv) {
+    const uint64_t num_msgs = (argc > 1) ? std::stoull(argv[1]) : 1000000ULL;
+    const size_t   payload  = (argc > 2) ? static_cast<size_t>(std::stoull(argv[2])) : 100;
+    const uint16_t port = 55668;
+
+    if (payload == 0 || payload > UDP_MAX_LEN) {
+        std::cerr << "payload_bytes must be between 1 and " << UDP_MAX_LEN << "\n";
+        return 1;
+    }
+
+    std::cout << "[client] PID=" << getpid()
+              << " num_msgs=" << num_msgs
+              << " payload=" << payload
+              << " port=" << port << "\n";
+
+    struct Mode { const char* name; SendFn fn; };
+    const Mode modes[] = {{"sendto", send_per_message}, {"sendmmsg", send_mmsg}, {"gso", send_gso}};
+    std::vector<char> msg(payload, 'x');
+    const sockaddr_in dst = loopback_addr(port);
+
+    std::cout << std::left << std::setw(10) << "Mode"
+              << std::right << std::setw(8) << "Batch"
+              << std::setw(14) << "msgs/s"
+              << std::setw(10) << "drop %"
+              << std::setw(14) << "tx ns/msg"
+              << std::setw(14) << "rx ns/msg" << "\n";
+
+    for (const Mode& m : modes) {
+        for (uint64_t batch_sz : BATCH_SIZES) {
+            int rfd = make_receiver(port);
+            std::atomic<bool> done{false};
+            RecvStats rs;
+            std::thread rx(receiver_fn, rfd, &done, &rs);
+
+            int sfd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            if (sfd < 0) { perror("socket"); return 1; }
+            set_buf(sfd, SO_SNDBUFFORCE, SO_SNDBUF, SOCK_BUF);
+
+            double cpu0 = cpu_sec();
+            auto t0 = std::chrono::steady_clock::now();
+            m.fn(sfd, dst, msg.data(), payload, num_msgs, batch_sz);
+            auto t1 = std::chrono::steady_clock::now();
+            double tx_cpu = cpu_sec() - cpu0;
+
+            done.store(true);
+            rx.join();
+            ::close(sfd);
+            ::close(rfd);
+
+            double sec = std::chrono::duration<double>(t1 - t0).count();
+            double drop = 100.0 * (1.0 - static_cast<double>(rs.msgs) / num_msgs);
+            std::cout << std::left << std::setw(10) << m.name
+                      << std::right << std::setw(8) << batch_sz
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(14) << num_msgs / sec
+                      << std::setprecision(2)
+                      << std::setw(10) << drop
+                      << std::setprecision(1)
+                      << std::setw(14) << tx_cpu * 1e9 / num_msgs
+                      << std::setw(14) << (rs.msgs ? rs.cpu * 1e9 / rs.msgs : 0.0) << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            const std::string params = "batch=" + std::to_string(batch_sz) + " payload=" + std::to_string(payload);
+            bench::record("udp_batch", m.name, params, num_msgs / sec, "msgs/s", bench::HIGHER);
+            bench::record("udp_batch", std::string(m.name) + " drop", params, drop, "%", bench::LOWER);
+
+            // sendto ignores the batch size, so one row is enough.
+            if (m.fn == send_per_message) break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// qsbr.h - quiescent-state-based reclamation (userspace RCU, QSBR flavour)
+// for read-mostly shared state.
+//
+//   Qsbr rcu;
+//   RcuPtr<Table> table(new Table);
+//
+//   // reader thread
+//   Qsbr::Reader r(rcu);
+//   for (;;) {
+//       const Table* t = table.load();   // plain acquire load: no lock, no store
+//       use(t);
+//       r.quiescent();                   // "I hold no references" between batches
+//   }
+//
+//   // writer thread (not itself an online reader)
+//   rcu.publish(table, new Table(*table.load()));   // swap in, retire the old one
+//   rcu.synchronize();                               // wait a grace period, free it
+//
+// Reader sections write nothing shared. Each reader owns one cache line
+// holding the last global epoch it has seen; it stores to that line only at
+// quiescent points, and only when the epoch has moved since its last
+// announcement. A writer publishes a new version with an exchange, retires
+// the old one tagged with a fresh epoch, and frees it once every online
+// reader has announced that epoch. synchronize() waits for that;
+// try_reclaim() frees what is already safe without waiting.
+//
+// A reader holds references only between quiescent()/offline() calls. Call
+// offline() before blocking for long so writers need not wait for it, and
+// never call synchronize() from a thread whose Reader is online.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A pointer to the current version of some read-mostly object.
+template <class T>
+class RcuPtr {
+public:
+    explicit RcuPtr(T* p = nullptr) : p_(p) {}
+    RcuPtr(const RcuPtr&) = delete;
+    RcuPtr& operator=(const RcuPtr&) = delete;
+
+    // Valid until the calling reader's next quiescent()/offline().
+    T* load() const { return p_.load(std::memory_order_acquire); }
+    // Writer side: installs `next`, returns the previous version.
+    T* exchange(T* next) { return p_.exchange(next, std::memory_order_acq_rel); }
+
+private:
+    std::atomic<T*> p_;
+};
+
+class Qsbr {
+    struct Slot;
+
+public:
+    static constexpr size_t MAX_READERS = 256;
+
+    Qsbr() = default;
+    Qsbr(const Qsbr&) = delete;
+    Qsbr& operator=(const Qsbr&) = delete;
+    // No Reader may still be registered.
+    ~Qsbr() { free_up_to(UINT64_MAX); }
+
+    // Registration of one reader thread; online from construction until
+    // destruction unless offline() is called.
+    class Reader {
+    public:
+        explicit Reader(Qsbr& q) : q_(q), slot_(q.claim_slot()) { online(); }
+        ~Reader() {
+            offline();
+            slot_->used.store(false, std::memory_order_release);
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // The caller holds no references obtained before this point.
+        void quiescent() {
+            uint64_t e = q_.epoch_.load(std::memory_order_acquire);
+            if (slot_->seen.load(std::memory_order_relaxed) != e) slot_->seen.store(e, std::memory_order_release);
+        }
+
+        // Stop being waited for; drop all references first.
+        void offline() { slot_->seen.store(0, std::memory_order_release); }
+
+        // Resume reading. The fence orders the announcement before any
+        // pointer load against a writer's epoch bump before its scan.
+        void online() {
+            slot_->seen.store(q_.epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+    private:
+        Qsbr& q_;
+        Slot* slot_;
+    };
+
+    // Hands `p` to the reclaimer; `del(p)` runs once no reader can see it.
+    // `p` must already be unreachable for new readers.
+    void retire(void* p, void (*del)(void*)) { defer([p, del] { del(p); }); }
+
+    // Typed form; `del` defaults to delete.
+    template <class T>
+    void retire(T* p, void (*del)(T*) = [](T* q) { delete q; }) {
+        defer([p, del] { del(p); });
+    }
+
+    // Installs `next` in `ptr` and retires the version it replaces with `del`.
+    template <class T>
+    void publish(RcuPtr<T>& ptr, T* next, void (*del)(T*) = [](T* q) { delete q; }) {
+        if (T* old = ptr.exchange(next)) retire(old, del);
+    }
+
+    // Waits until every online reader has passed a quiescent state after
+    // this call started, then frees everything retired before it.
+    void synchronize() {
+        const uint64_t target = epoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const size_t n = high_water_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            const Slot& s = slots_[i];
+            for (;;) {
+                uint64_t seen = s.seen.load(std::memory_order_acquire);
+                if (seen == 0 || seen >= target) break;
+                std::this_thread::yield();
+            }
+        }
+        free_up_to(target);
+    }
+
+    // Frees whatever every online reader has already moved past; never waits.
+    // Returns how many objects were freed.
+    size_t try_reclaim() {
+        uint64_t safe = epoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const size_t n = high_water_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t seen = slots_[i].seen.load(std::memory_order_acquire);
+            if (seen != 0) safe = std::min(safe, seen);
+        }
+        return free_up_to(safe);
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lk(retired_mu_);
+        return retired_.size();
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seen{0};  // 0 = offline
+        std::atomic<bool> used{false};
+    };
+
+    struct Retired {
+        std::function<void()> free;
+        uint64_t tag;
+    };
+
+    void defer(std::function<void()> free) {
+        uint64_t tag = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        std::lock_guard<std::mutex> lk(retired_mu_);
+        retired_.push_back({std::move(free), tag});
+    }
+
+    Slot* claim_slot() {
+        for (size_t i = 0; i < MAX_READERS; ++i) {
+            bool expected = false;
+            if (slots_[i].used.load(std::memory_order_relaxed) ||
+                !slots_[i].used.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                continue;
+            size_t hw = high_water_.load(std::memory_order_relaxed);
+            while (hw < i + 1 && !high_water_.compare_exchange_weak(hw, i + 1, std::memory_order_acq_rel)) {
+            }
+            return &slots_[i];
+        }
+        fprintf(stderr, "Qsbr: more than %zu readers\n", MAX_READERS);
+        exit(1);
+    }
+
+    // Deletes retired objects tagged <= `safe`, outside the lock.
+    size_t free_up_to(uint64_t safe) {
+        std::vector<Retired> done;
+        {
+            std::lock_guard<std::mutex> lk(retired_mu_);
+            auto mid = std::stable_partition(retired_.begin(), retired_.end(),
+                                             [safe](const Retired& r) { return r.tag > safe; });
+            done.assign(std::make_move_iterator(mid), std::make_move_iterator(retired_.end()));
+            retired_.erase(mid, retired_.end());
+        }
+        for (const Retired& r : done) r.free();
+        return done.size();
+    }
+
+    alignas(64) std::atomic<uint64_t> epoch_{1};
+    alignas(64) std::atomic<size_t> high_water_{0};
+    Slot slots_[MAX_READERS];
+    std::mutex retired_mu_;
+    std::vector<Retired> retired_;
+};
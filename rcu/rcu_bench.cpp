@@ -0,0 +1,275 @@
+// g++ -O2 -std=c++20 rcu_bench.cpp -o rcu_bench -lpthread
+// ./rcu_bench [max_readers] [duration_ms] [update_gap_us]
+//
+// A read-mostly routing table (4096 next hops) shared by N reader threads and
+// one writer that builds and installs a new version every update_gap_us.
+// Three ways to share it:
+//   rwlock:     pthread_rwlock_t (writer-preferring; the default kind lets
+//               readers starve the writer for seconds) around every lookup;
+//               the writer frees the old version after unlocking;
+//   shared_ptr: std::atomic<std::shared_ptr<Table>>, one load per lookup;
+//               the last reference frees the old version;
+//   qsbr:       RcuPtr + Qsbr (qsbr.h): a plain acquire load per lookup and
+//               a quiescent() every QS_BATCH lookups; the writer calls
+//               publish() and waits for a grace period with synchronize().
+// Reported: total lookups/s across readers, and update latency from install
+// until the old version is freed (for shared_ptr: until store() returns).
+// "Freed" tables are poisoned and parked in a quarantine for the next
+// QUARANTINE frees before the real delete, and readers count lookups that
+// saw a poisoned or torn table.
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "qsbr.h"
+#include "../common/bench_results.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+constexpr size_t TABLE_SIZE = 4096;
+constexpr int QS_BATCH = 64;  // lookups between stop checks / quiescent states
+constexpr uint32_t POISON = 0xdeaddeadu;
+constexpr size_t QUARANTINE = 64;  // freed tables kept poisoned before the real delete
+
+struct Table {
+    uint64_t version;
+    uint32_t hop[TABLE_SIZE];
+};
+
+Table* make_table(uint64_t version) {
+    Table* t = new Table;
+    t->version = version;
+    fill(begin(t->hop), end(t->hop), static_cast<uint32_t>(version));
+    return t;
+}
+
+// Deleting right away would let malloc reuse the memory and overwrite the
+// poison (its free-list pointers land on the first bytes), so a use after
+// free would read plausible data. Freed tables are poisoned and kept here
+// until QUARANTINE later frees have happened. Called from the writer, and
+// from readers when they drop the last shared_ptr.
+struct Quarantine {
+    mutex mu;
+    vector<Table*> ring;
+    size_t next = 0;
+
+    void put(Table* t) {
+        t->version = POISON;
+        fill(begin(t->hop), end(t->hop), POISON);
+        lock_guard<mutex> lk(mu);
+        if (ring.size() < QUARANTINE) {
+            ring.push_back(t);
+            return;
+        }
+        delete ring[next];
+        ring[next] = t;
+        next = (next + 1) % QUARANTINE;
+    }
+    ~Quarantine() {
+        for (Table* t : ring) delete t;
+    }
+};
+Quarantine g_quarantine;
+
+void free_table(Table* t) { g_quarantine.put(t); }
+
+// Returns 1 if the table was freed or half-updated.
+inline int lookup(const Table* t, uint32_t key, uint64_t& sum) {
+    uint64_t v = t->version;
+    uint32_t h = t->hop[key % TABLE_SIZE];
+    sum += h;
+    return v == POISON || h == POISON || h != static_cast<uint32_t>(v);
+}
+
+inline uint32_t next_key(uint32_t& x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+struct ReaderResult {
+    uint64_t lookups = 0, bad = 0, sum = 0;
+};
+
+// One mode: how readers look up, how the writer installs a new version.
+struct Design {
+    virtual ~Design() = default;
+    // Runs until `stop`, doing QS_BATCH lookups between checks.
+    virtual void reader(const atomic<bool>& stop, ReaderResult& r, uint32_t seed) = 0;
+    // Installs `next` and returns once the previous version is gone.
+    virtual void update(Table* next) = 0;
+};
+
+struct RwlockDesign : Design {
+    pthread_rwlock_t lock;
+    Table* table = make_table(1);
+
+    RwlockDesign() {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        pthread_rwlock_init(&lock, &attr);
+        pthread_rwlockattr_destroy(&attr);
+    }
+    ~RwlockDesign() override {
+        pthread_rwlock_destroy(&lock);
+        free_table(table);
+    }
+
+    void reader(const atomic<bool>& stop, ReaderResult& r, uint32_t seed) override {
+        while (!stop.load(memory_order_relaxed)) {
+            for (int i = 0; i < QS_BATCH; ++i) {
+                pthread_rwlock_rdlock(&lock);
+                r.bad += lookup(table, next_key(seed), r.sum);
+                pthread_rwlock_unlock(&lock);
+            }
+            r.lookups += QS_BATCH;
+        }
+    }
+    void update(Table* next) override {
+        pthread_rwlock_wrlock(&lock);
+        Table* old = table;
+        table = next;
+        pthread_rwlock_unlock(&lock);
+        free_table(old);
+    }
+};
+
+struct SharedPtrDesign : Design {
+    atomic<shared_ptr<Table>> table{shared_ptr<Table>(make_table(1), free_table)};
+
+    void reader(const atomic<bool>& stop, ReaderResult& r, uint32_t seed) override {
+        while (!stop.load(memory_order_relaxed)) {
+            for (int i = 0; i < QS_BATCH; ++i) {
+                shared_ptr<Table> t = table.load(memory_order_acquire);
+                r.bad += lookup(t.get(), next_key(seed), r.sum);
+            }
+            r.lookups += QS_BATCH;
+        }
+    }
+    void update(Table* next) override { table.store(shared_ptr<Table>(next, free_table), memory_order_release); }
+};
+
+struct QsbrDesign : Design {
+    Qsbr rcu;
+    RcuPtr<Table> table{make_table(1)};
+    ~QsbrDesign() override { free_table(table.load()); }
+
+    void reader(const atomic<bool>& stop, ReaderResult& r, uint32_t seed) override {
+        Qsbr::Reader rd(rcu);
+        while (!stop.load(memory_order_relaxed)) {
+            for (int i = 0; i < QS_BATCH; ++i) r.bad += lookup(table.load(), next_key(seed), r.sum);
+            r.lookups += QS_BATCH;
+            rd.quiescent();
+        }
+    }
+    void update(Table* next) override {
+        rcu.publish(table, next, free_table);
+        rcu.synchronize();
+    }
+};
+
+struct Result {
+    double lookups_per_sec;
+    uint64_t bad;
+    size_t updates;
+    double upd_p50_us, upd_p99_us, upd_max_us;
+};
+
+Result run(Design& d, int readers, int duration_ms, int gap_us) {
+    atomic<bool> stop{false};
+    vector<ReaderResult> rr(readers);
+    vector<thread> threads;
+    auto start = Clock::now();
+    for (int i = 0; i < readers; ++i)
+        threads.emplace_back([&, i] { d.reader(stop, rr[i], 0x9e3779b9u * (i + 1)); });
+
+    // The writer is the main thread.
+    vector<double> lat;
+    uint64_t version = 1;
+    auto end = start + chrono::milliseconds(duration_ms);
+    while (Clock::now() < end) {
+        this_thread::sleep_for(chrono::microseconds(gap_us));
+        Table* next = make_table(++version);
+        auto t0 = Clock::now();
+        d.update(next);
+        lat.push_back(chrono::duration<double, micro>(Clock::now() - t0).count());
+    }
+    stop.store(true, memory_order_relaxed);
+    for (auto& t : threads) t.join();
+    double sec = chrono::duration<double>(Clock::now() - start).count();
+
+    Result r{0, 0, lat.size(), 0, 0, 0};
+    uint64_t total = 0;
+    for (const auto& x : rr) {
+        total += x.lookups;
+        r.bad += x.bad;
+    }
+    r.lookups_per_sec = total / sec;
+    if (!lat.empty()) {
+        sort(lat.begin(), lat.end());
+        r.upd_p50_us = lat[lat.size() / 2];
+        r.upd_p99_us = lat[min(lat.size() - 1, lat.size() * 99 / 100)];
+        r.upd_max_us = lat.back();
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int max_readers = (argc > 1) ? atoi(argv[1]) : 8;
+    int duration_ms = (argc > 2) ? atoi(argv[2]) : 1000;
+    int gap_us = (argc > 3) ? atoi(argv[3]) : 1000;
+    if (max_readers <= 0 || duration_ms <= 0 || gap_us < 0) {
+        cerr << "Usage: " << argv[0] << " [max_readers] [duration_ms] [update_gap_us]\n";
+        return 1;
+    }
+
+    struct Mode {
+        const char* name;
+        function<unique_ptr<Design>()> make;
+    };
+    const Mode modes[] = {
+        {"rwlock", [] { return unique_ptr<Design>(new RwlockDesign); }},
+        {"shared_ptr", [] { return unique_ptr<Design>(new SharedPtrDesign); }},
+        {"qsbr", [] { return unique_ptr<Design>(new QsbrDesign); }},
+    };
+
+    cout << "Table " << TABLE_SIZE << " hops, one update every " << gap_us << " us, " << duration_ms
+         << " ms per run\n";
+    cout << left << setw(12) << "Mode" << right << setw(8) << "Readers" << setw(14) << "Mlookups/s"
+         << setw(9) << "updates" << setw(12) << "upd p50 us" << setw(12) << "upd p99 us" << setw(12)
+         << "upd max us" << setw(6) << "bad" << "\n";
+
+    int rc = 0;
+    for (int n = 1; n <= max_readers; n *= 2) {
+        for (const Mode& m : modes) {
+            unique_ptr<Design> d = m.make();
+            Result r = run(*d, n, duration_ms, gap_us);
+            rc |= r.bad != 0;
+            cout << left << setw(12) << m.name << right << setw(8) << n << fixed << setprecision(2)
+                 << setw(14) << r.lookups_per_sec / 1e6 << setw(9) << r.updates << setprecision(1)
+                 << setw(12) << r.upd_p50_us << setw(12) << r.upd_p99_us << setw(12) << r.upd_max_us
+                 << setw(6) << r.bad << "\n";
+            cout.unsetf(ios::fixed);
+            const string params = "readers=" + to_string(n) + " gap_us=" + to_string(gap_us);
+            bench::record("rcu", string(m.name) + " lookups", params, r.lookups_per_sec, "lookups/s",
+                          bench::HIGHER);
+            bench::record("rcu", string(m.name) + " update p99", params, r.upd_p99_us, "us", bench::LOWER);
+        }
+    }
+    return rc;
+}
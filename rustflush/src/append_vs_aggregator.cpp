@@ -0,0 +1,334 @@
+// g++ -O2 -std=c++17 append_vs_aggregator.cpp -o append_vs_aggregator -lpthread
+// ./append_vs_aggregator [writers] [records_per_writer]
+//
+// C++ counterpart of multi_writer in main.rs: N writers append records to one
+// log file, either directly through their own O_APPEND fd (threads or forked
+// processes), or by handing records to a single aggregator thread that
+// gathers them into one writev per batch. The file is then re-read and every
+// record checked for tearing/interleaving. Data stays in the page cache (no
+// fsync), like the write + flush loop in main.rs.
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench_results.h"
+
+constexpr const char* LOG_PATH = "append_bench.log";
+constexpr size_t RECORD_SIZES[] = {64, 512, 4096};
+constexpr uint32_t RECORD_MAGIC = 0x52454331;  // "REC1"
+constexpr size_t SLOTS_PER_WRITER = 64;         // records a writer may have queued
+constexpr int MAX_BATCH_IOV = IOV_MAX;
+
+using Clock = std::chrono::steady_clock;
+
+// ---------------- Records ----------------
+// [magic][size][writer][seq][checksum][body...], body bytes derived from
+// (writer, seq) so a torn or interleaved record fails the checksum.
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t writer;
+    uint32_t seq;
+    uint64_t checksum;
+};
+
+static uint64_t fnv1a(const char* p, size_t n) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void build_record(char* out, size_t size, uint32_t writer, uint32_t seq) {
+    char* body = out + sizeof(RecordHeader);
+    size_t body_len = size - sizeof(RecordHeader);
+    std::memset(body, 'a' + static_cast<char>((writer + seq) % 26), body_len);
+    RecordHeader h{RECORD_MAGIC, static_cast<uint32_t>(size), writer, seq, fnv1a(body, body_len)};
+    std::memcpy(out, &h, sizeof(h));
+}
+
+struct VerifyResult {
+    uint64_t good = 0;
+    uint64_t corrupt = 0;
+    uint64_t missing = 0;
+};
+
+// A corrupt record means the rest of the file can no longer be framed, so
+// everything after it is reported as missing.
+static VerifyResult verify_log(size_t size, int writers, uint32_t per_writer) {
+    VerifyResult v;
+    std::vector<std::vector<bool>> seen(writers, std::vector<bool>(per_writer, false));
+    int fd = ::open(LOG_PATH, O_RDONLY);
+    if (fd < 0) { perror("open (verify)"); std::exit(1); }
+    std::vector<char> rec(size);
+    for (;;) {
+        ssize_t n = ::read(fd, rec.data(), size);
+        if (n == 0) break;
+        if (n != static_cast<ssize_t>(size)) { ++v.corrupt; break; }
+        RecordHeader h;
+        std::memcpy(&h, rec.data(), sizeof(h));
+        bool ok = h.magic == RECORD_MAGIC && h.size == size &&
+                  h.writer < static_cast<uint32_t>(writers) && h.seq < per_writer &&
+                  h.checksum == fnv1a(rec.data() + sizeof(h), size - sizeof(h)) &&
+                  !seen[h.writer][h.seq];
+        if (!ok) { ++v.corrupt; break; }
+        seen[h.writer][h.seq] = true;
+        ++v.good;
+    }
+    ::close(fd);
+    v.missing = static_cast<uint64_t>(writers) * per_writer - v.good;
+    return v;
+}
+
+static void write_all(int fd, const char* data, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = ::write(fd, data + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("write");
+            std::exit(1);
+        }
+        off += static_cast<size_t>(n);
+    }
+}
+
+static int open_log(bool truncate) {
+    int fd = ::open(LOG_PATH, O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+    if (fd < 0) { perror("open (log)"); std::exit(1); }
+    return fd;
+}
+
+// ---------------- O_APPEND writers ----------------
+// Each writer has its own O_APPEND fd and issues one write per record, so the
+// kernel's per-inode lock is the only serialization. lat_us[w * n + i] gets
+// the duration of that write.
+
+static void append_writer(int writer, size_t size, uint32_t n, double* lat_us) {
+    int fd = open_log(false);
+    std::vector<char> rec(size);
+    for (uint32_t i = 0; i < n; ++i) {
+        build_record(rec.data(), size, static_cast<uint32_t>(writer), i);
+        auto t0 = Clock::now();
+        write_all(fd, rec.data(), size);
+        lat_us[static_cast<size_t>(writer) * n + i] =
+            std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    }
+    ::close(fd);
+}
+
+static void run_append_threads(int writers, size_t size, uint32_t n, double* lat_us) {
+    std::vector<std::thread> ts;
+    for (int w = 0; w < writers; ++w) ts.emplace_back(append_writer, w, size, n, lat_us);
+    for (auto& t : ts) t.join();
+}
+
+static void run_append_processes(int writers, size_t size, uint32_t n, double* lat_us) {
+    std::vector<pid_t> pids;
+    for (int w = 0; w < writers; ++w) {
+        pid_t pid = ::fork();
+        if (pid < 0) { perror("fork"); std::exit(1); }
+        if (pid == 0) {
+            append_writer(w, size, n, lat_us);
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+    for (pid_t pid : pids) ::waitpid(pid, nullptr, 0);
+}
+
+// ---------------- Aggregator ----------------
+// Writers build each record in one of their own slots and enqueue a pointer
+// to it; the aggregator takes the whole queue, writes it with one writev per
+// IOV_MAX records, and only then marks the slots reusable. Append latency is
+// enqueue -> writev completion, i.e. when the record is in the file.
+
+class Aggregator {
+public:
+    Aggregator(int writers, size_t size, uint32_t n, double* lat_us)
+        : size_(size), n_(n), lat_us_(lat_us),
+          slots_(static_cast<size_t>(writers) * SLOTS_PER_WRITER * size),
+          completed_(writers) {
+        for (auto& c : completed_) c.value.store(0);
+        fd_ = open_log(false);
+    }
+
+    ~Aggregator() { ::close(fd_); }
+
+    void producer(uint32_t writer) {
+        for (uint32_t i = 0; i < n_; ++i) {
+            // Slot i % SLOTS_PER_WRITER is free once record i - SLOTS_PER_WRITER is written.
+            while (i >= SLOTS_PER_WRITER + completed_[writer].value.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            char* slot = slots_.data() + (static_cast<size_t>(writer) * SLOTS_PER_WRITER +
+                                          i % SLOTS_PER_WRITER) * size_;
+            build_record(slot, size_, writer, i);
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                queue_.push_back({slot, writer, i, Clock::now()});
+            }
+            cv_.notify_one();
+        }
+    }
+
+    void run(int writers) {
+        std::vector<Entry> batch;
+        std::vector<iovec> iov;
+        uint64_t remaining = static_cast<uint64_t>(writers) * n_;
+        while (remaining > 0) {
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [&] { return !queue_.empty(); });
+                batch.swap(queue_);
+            }
+            for (size_t start = 0; start < batch.size(); start += MAX_BATCH_IOV) {
+                size_t end = std::min(batch.size(), start + MAX_BATCH_IOV);
+                iov.clear();
+                for (size_t i = start; i < end; ++i) iov.push_back({const_cast<char*>(batch[i].data), size_});
+                writev_all(iov);
+                auto done = Clock::now();
+                for (size_t i = start; i < end; ++i) {
+                    const Entry& e = batch[i];
+                    lat_us_[static_cast<size_t>(e.writer) * n_ + e.seq] =
+                        std::chrono::duration<double, std::micro>(done - e.enqueued).count();
+                    completed_[e.writer].value.fetch_add(1, std::memory_order_release);
+                }
+            }
+            remaining -= batch.size();
+            batch.clear();
+        }
+    }
+
+private:
+    struct Entry {
+        const char* data;
+        uint32_t writer;
+        uint32_t seq;
+        Clock::time_point enqueued;
+    };
+    struct alignas(64) Counter { std::atomic<uint32_t> value; };
+
+    void writev_all(std::vector<iovec>& iov) {
+        iovec* v = iov.data();
+        int cnt = static_cast<int>(iov.size());
+        while (cnt > 0) {
+            ssize_t n = ::writev(fd_, v, cnt);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("writev");
+                std::exit(1);
+            }
+            size_t left = static_cast<size_t>(n);
+            while (cnt > 0 && left >= v->iov_len) { left -= v->iov_len; ++v; --cnt; }
+            if (cnt > 0) {
+                v->iov_base = static_cast<char*>(v->iov_base) + left;
+                v->iov_len -= left;
+            }
+        }
+    }
+
+    size_t size_;
+    uint32_t n_;
+    double* lat_us_;
+    int fd_;
+    std::vector<char> slots_;
+    std::vector<Counter> completed_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::vector<Entry> queue_;
+};
+
+static void run_aggregator(int writers, size_t size, uint32_t n, double* lat_us) {
+    Aggregator agg(writers, size, n, lat_us);
+    std::thread writer_thread([&] { agg.run(writers); });
+    std::vector<std::thread> ts;
+    for (int w = 0; w < writers; ++w)
+        ts.emplace_back([&, w] { agg.producer(static_cast<uint32_t>(w)); });
+    for (auto& t : ts) t.join();
+    writer_thread.join();
+}
+
+// ---------------- Main ----------------
+
+static double percentile(std::vector<double>& v, double p) {
+    size_t idx = std::min(v.size() - 1, static_cast<size_t>(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+int main(int argc, char** argv) {
+    const int writers = (argc > 1) ? std::stoi(argv[1]) : 8;
+    const uint32_t per_writer = (argc > 2) ? static_cast<uint32_t>(std::stoul(argv[2])) : 100000;
+    const size_t total = static_cast<size_t>(writers) * per_writer;
+
+    std::cout << "Writers: " << writers << ", records/writer: " << per_writer << "\n";
+    std::cout << std::left << std::setw(18) << "Mode"
+              << std::right << std::setw(8) << "Size"
+              << std::setw(14) << "records/s"
+              << std::setw(10) << "p50 us"
+              << std::setw(10) << "p99 us"
+              << std::setw(11) << "p99.9 us"
+              << std::setw(9) << "corrupt"
+              << std::setw(9) << "missing" << "\n";
+
+    // Shared so forked writers can report their latencies back.
+    auto* lat_us = static_cast<double*>(::mmap(nullptr, total * sizeof(double), PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if (lat_us == MAP_FAILED) { perror("mmap"); return 1; }
+
+    struct Mode { const char* name; void (*fn)(int, size_t, uint32_t, double*); };
+    const Mode modes[] = {{"append threads", run_append_threads},
+                          {"append processes", run_append_processes},
+                          {"aggregator", run_aggregator}};
+
+    int rc = 0;
+    for (size_t size : RECORD_SIZES) {
+        for (const Mode& m : modes) {
+            ::close(open_log(true));
+            auto t0 = Clock::now();
+            m.fn(writers, size, per_writer, lat_us);
+            double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+            VerifyResult v = verify_log(size, writers, per_writer);
+            if (v.corrupt || v.missing) rc = 1;
+
+            std::vector<double> lat(lat_us, lat_us + total);
+            std::cout << std::left << std::setw(18) << m.name
+                      << std::right << std::setw(8) << size
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(14) << total / sec
+                      << std::setprecision(2)
+                      << std::setw(10) << percentile(lat, 0.50)
+                      << std::setw(10) << percentile(lat, 0.99)
+                      << std::setw(11) << percentile(lat, 0.999)
+                      << std::setw(9) << v.corrupt
+                      << std::setw(9) << v.missing << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            const std::string params = "writers=" + std::to_string(writers) + " size=" + std::to_string(size);
+            bench::record("append_vs_aggregator", m.name, params, total / sec, "records/s", bench::HIGHER);
+            bench::record("append_vs_aggregator", std::string(m.name) + " p99", params, percentile(lat, 0.99), "us",
+                          bench::LOWER);
+        }
+    }
+
+    ::munmap(lat_us, total * sizeof(double));
+    ::unlink(LOG_PATH);
+    return rc;
+}
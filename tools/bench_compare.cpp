@@ -0,0 +1,221 @@
+// g++ -O2 -std=c++17 bench_compare.cpp -o bench_compare
+// ./bench_compare results.tsv                          # list runs
+// ./bench_compare results.tsv <base_run> <new_run> [threshold_pct] [alpha]
+//
+// Compares two runs recorded through common/bench_results.h. Rows are grouped
+// by (benchmark, metric, params); each group's repetitions in the base and
+// new run are compared with a two-sided Mann-Whitney U test (exact for small
+// samples without ties, normal approximation otherwise). A group is flagged
+// REGRESSION when p < alpha (default 0.05) and the median moved in the bad
+// direction by at least threshold_pct (default 5). Environment fields that
+// differ between the runs are printed first. Exit status is 1 if anything
+// regressed.
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr const char* ENV_FIELDS[] = {"host", "cpu", "cpus", "kernel", "governor", "compiler", "flags"};
+constexpr size_t EXACT_MAX_N = 30;  // combined sample size for the exact U distribution
+
+struct Row {
+    map<string, string> f;
+    const string& operator[](const string& k) const {
+        static const string empty;
+        auto it = f.find(k);
+        return it == f.end() ? empty : it->second;
+    }
+};
+
+vector<string> split_tabs(const string& line) {
+    vector<string> out;
+    stringstream ss(line);
+    string cell;
+    while (getline(ss, cell, '\t')) out.push_back(cell);
+    return out;
+}
+
+vector<Row> load(const char* path) {
+    ifstream in(path);
+    if (!in) { perror(path); exit(2); }
+    string line;
+    if (!getline(in, line)) { cerr << path << ": empty\n"; exit(2); }
+    vector<string> cols = split_tabs(line);
+    vector<Row> rows;
+    while (getline(in, line)) {
+        if (line.empty() || line.compare(0, 4, "run\t") == 0) continue;  // repeated header
+        vector<string> cells = split_tabs(line);
+        Row r;
+        for (size_t i = 0; i < cols.size() && i < cells.size(); ++i) r.f[cols[i]] = cells[i];
+        rows.push_back(move(r));
+    }
+    return rows;
+}
+
+double median(vector<double> v) {
+    sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// Number of (m, n) rank arrangements for each value of U, by the recurrence
+// f(m, n, u) = f(m-1, n, u-n) + f(m, n-1, u).
+vector<double> u_distribution(size_t m, size_t n) {
+    vector<vector<vector<double>>> f(m + 1, vector<vector<double>>(n + 1));
+    for (size_t i = 0; i <= m; ++i) {
+        for (size_t j = 0; j <= n; ++j) {
+            f[i][j].assign(i * j + 1, 0.0);
+            if (i == 0 || j == 0) {
+                f[i][j][0] = 1;
+                continue;
+            }
+            for (size_t u = 0; u <= i * j; ++u) {
+                double a = (u >= j && u - j < f[i - 1][j].size()) ? f[i - 1][j][u - j] : 0;
+                double b = u < f[i][j - 1].size() ? f[i][j - 1][u] : 0;
+                f[i][j][u] = a + b;
+            }
+        }
+    }
+    return f[m][n];
+}
+
+// Two-sided Mann-Whitney U p-value for samples a and b.
+double mann_whitney_p(const vector<double>& a, const vector<double>& b) {
+    const size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+    vector<pair<double, int>> all;
+    for (double x : a) all.push_back({x, 0});
+    for (double x : b) all.push_back({x, 1});
+    sort(all.begin(), all.end());
+
+    double r1 = 0, tie_term = 0;
+    bool ties = false;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first) ++j;
+        double rank = (i + 1 + j) / 2.0;  // average of ranks i+1 .. j
+        for (size_t k = i; k < j; ++k)
+            if (all[k].second == 0) r1 += rank;
+        double t = double(j - i);
+        if (t > 1) ties = true;
+        tie_term += t * t * t - t;
+        i = j;
+    }
+    double u1 = r1 - n1 * (n1 + 1) / 2.0;
+
+    if (!ties && n <= EXACT_MAX_N) {
+        vector<double> dist = u_distribution(n1, n2);
+        double total = 0, le = 0, ge = 0;
+        for (size_t u = 0; u < dist.size(); ++u) {
+            total += dist[u];
+            if (u <= u1) le += dist[u];
+            if (u >= u1) ge += dist[u];
+        }
+        return min(1.0, 2 * min(le, ge) / total);
+    }
+
+    double mu = n1 * n2 / 2.0;
+    double var = n1 * n2 / 12.0 * ((n + 1) - tie_term / (double(n) * (n - 1)));
+    if (var <= 0) return 1.0;
+    double z = (fabs(u1 - mu) - 0.5) / sqrt(var);
+    if (z < 0) z = 0;
+    return erfc(z / sqrt(2.0));
+}
+
+void list_runs(const vector<Row>& rows) {
+    map<string, pair<size_t, Row>> runs;
+    for (const Row& r : rows) {
+        auto& e = runs[r["run"]];
+        if (e.first++ == 0) e.second = r;
+    }
+    for (const auto& [name, e] : runs) {
+        cout << name << ": " << e.first << " rows, first " << e.second["time"] << "\n";
+        for (const char* k : ENV_FIELDS) cout << "    " << setw(9) << left << k << e.second[k] << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && (argc < 4 || argc > 6)) {
+        cerr << "Usage: " << argv[0] << " results.tsv [base_run new_run [threshold_pct] [alpha]]\n";
+        return 2;
+    }
+    vector<Row> rows = load(argv[1]);
+    if (argc == 2) {
+        list_runs(rows);
+        return 0;
+    }
+    const string base = argv[2], cand = argv[3];
+    const double threshold = (argc > 4) ? atof(argv[4]) : 5.0;
+    const double alpha = (argc > 5) ? atof(argv[5]) : 0.05;
+
+    // Environment drift between the runs.
+    map<string, set<string>> env[2];
+    for (const Row& r : rows) {
+        int side = r["run"] == base ? 0 : r["run"] == cand ? 1 : -1;
+        if (side < 0) continue;
+        for (const char* k : ENV_FIELDS) env[side][k].insert(r[k]);
+    }
+    if (env[0].empty() || env[1].empty()) {
+        cerr << "run '" << (env[0].empty() ? base : cand) << "' not found in " << argv[1] << "\n";
+        return 2;
+    }
+    auto joined = [](const set<string>& s) {
+        string out;
+        for (const string& v : s) out += (out.empty() ? "" : " | ") + v;
+        return out;
+    };
+    for (const char* k : ENV_FIELDS) {
+        if (env[0][k] == env[1][k]) continue;
+        cout << "env " << k << ": " << joined(env[0][k]) << "  ->  " << joined(env[1][k]) << "\n";
+    }
+
+    struct Group {
+        vector<double> v[2];
+        string unit, better;
+    };
+    map<tuple<string, string, string>, Group> groups;
+    for (const Row& r : rows) {
+        int side = r["run"] == base ? 0 : r["run"] == cand ? 1 : -1;
+        if (side < 0) continue;
+        Group& g = groups[{r["benchmark"], r["metric"], r["params"]}];
+        g.v[side].push_back(atof(r["value"].c_str()));
+        g.unit = r["unit"];
+        g.better = r["better"];
+    }
+
+    cout << left << setw(20) << "Benchmark" << setw(24) << "Metric" << setw(26) << "Params" << right
+         << setw(5) << "n" << setw(13) << "base" << setw(13) << "new" << setw(9) << "delta%"
+         << setw(9) << "p" << "  verdict\n";
+    int regressions = 0;
+    for (const auto& [key, g] : groups) {
+        if (g.v[0].empty() || g.v[1].empty()) continue;
+        const auto& [bench, metric, params] = key;
+        double m0 = median(g.v[0]), m1 = median(g.v[1]);
+        double delta = m0 != 0 ? (m1 - m0) / fabs(m0) * 100.0 : 0.0;
+        double p = mann_whitney_p(g.v[0], g.v[1]);
+        bool worse = g.better == "higher" ? delta < 0 : delta > 0;
+
+        string verdict = "~";
+        if (p < alpha && fabs(delta) >= threshold) {
+            verdict = worse ? "REGRESSION" : "improved";
+            if (worse) ++regressions;
+        } else if (min(g.v[0].size(), g.v[1].size()) < 4) {
+            verdict = "~ (need >=4 reps each)";
+        }
+        string n = to_string(g.v[0].size()) + "/" + to_string(g.v[1].size());
+        cout << left << setw(20) << bench << setw(24) << metric << setw(26) << params << right
+             << setw(5) << n << setw(13) << setprecision(5) << m0 << setw(13) << m1
+             << fixed << setprecision(1) << setw(9) << delta << setprecision(3) << setw(9) << p;
+        cout.unsetf(ios::fixed);
+        cout << "  " << verdict << "  [" << g.unit << ", " << g.better << " is better]\n";
+    }
+    cout << regressions << " regression(s) at threshold " << threshold << "%, alpha " << alpha << "\n";
+    return regressions ? 1 : 0;
+}